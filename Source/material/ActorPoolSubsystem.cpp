@@ -0,0 +1,221 @@
+// ActorPoolSubsystem.cpp
+
+#include "ActorPoolSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "material.h"
+
+static FAutoConsoleCommandWithWorld CmdPoolStats(
+	TEXT("pool.Stats"),
+	TEXT("Logs free, in use and peak counts of every actor pool, for sizing the pre-warm counts of a level."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UActorPoolSubsystem* Pool = World ? World->GetSubsystem<UActorPoolSubsystem>() : nullptr)
+		{
+			Pool->DumpStats();
+		}
+	}));
+
+void FActorPool::AddFree(AActor* Actor)
+{
+	FreeIndices.Add(Actor, Free.Add(Actor));
+}
+
+AActor* FActorPool::PopFree()
+{
+	AActor* Actor = Free.Pop(EAllowShrinking::No);
+	FreeIndices.Remove(Actor);
+	return Actor;
+}
+
+bool FActorPool::RemoveFree(const AActor* Actor)
+{
+	int32 Index;
+	if (!FreeIndices.RemoveAndCopyValue(Actor, Index)) return false;
+
+	Free.RemoveAtSwap(Index, EAllowShrinking::No);
+	// the actor swapped in may have been nulled by GC, its stale key then never matches a live actor
+	if (Free.IsValidIndex(Index) && Free[Index])
+	{
+		FreeIndices.Add(Free[Index], Index);
+	}
+	return true;
+}
+
+void UActorPoolSubsystem::Deinitialize()
+{
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+void UActorPoolSubsystem::Prewarm(TSubclassOf<AActor> Class, int32 Count)
+{
+	if (!Class) return;
+
+	FActorPool& Pool = Pools.FindOrAdd(Class.Get());
+	Pool.Stats.Class = Class.Get();
+
+	while (Pool.Free.Num() < Count)
+	{
+		AActor* Actor = SpawnPooled(Class.Get(), FTransform::Identity);
+		if (!Actor) break;
+
+		++Pool.Stats.NumSpawned;
+		Park(Actor);
+		Pool.AddFree(Actor);
+	}
+}
+
+AActor* UActorPoolSubsystem::Acquire(TSubclassOf<AActor> Class, const FTransform& Transform)
+{
+	if (!Class) return nullptr;
+
+	FActorPool& Pool = Pools.FindOrAdd(Class.Get());
+	Pool.Stats.Class = Class.Get();
+
+	// parked actors can still be destroyed by level streaming or gameplay code
+	AActor* Actor = nullptr;
+	while (!Actor && Pool.Free.Num() > 0)
+	{
+		AActor* Candidate = Pool.PopFree();
+		Actor = IsValid(Candidate) ? Candidate : nullptr;
+	}
+
+	if (Actor)
+	{
+		Unpark(Actor, Transform);
+	}
+	else
+	{
+		Actor = SpawnPooled(Class.Get(), Transform);
+		if (!Actor) return nullptr;
+
+		++Pool.Stats.NumSpawned;
+		++Pool.Stats.NumMisses;
+	}
+
+	Pool.InUse.Add(Actor);
+	++Pool.Stats.NumAcquired;
+	Pool.Stats.PeakInUse = FMath::Max(Pool.Stats.PeakInUse, Pool.InUse.Num());
+	return Actor;
+}
+
+bool UActorPoolSubsystem::Reclaim(AActor* Actor, const FTransform& Transform)
+{
+	if (!IsValid(Actor)) return false;
+
+	FActorPool* Pool = Pools.Find(Actor->GetClass());
+	if (!Pool || !Pool->RemoveFree(Actor)) return false;
+
+	Unpark(Actor, Transform);
+
+	Pool->InUse.Add(Actor);
+	++Pool->Stats.NumAcquired;
+	Pool->Stats.PeakInUse = FMath::Max(Pool->Stats.PeakInUse, Pool->InUse.Num());
+	return true;
+}
+
+bool UActorPoolSubsystem::IsParked(const AActor* Actor) const
+{
+	const FActorPool* Pool = Actor ? Pools.Find(Actor->GetClass()) : nullptr;
+	return Pool && Pool->IsFree(Actor);
+}
+
+void UActorPoolSubsystem::Release(AActor* Actor)
+{
+	if (!IsValid(Actor)) return;
+
+	FActorPool& Pool = Pools.FindOrAdd(Actor->GetClass());
+	if (Pool.IsFree(Actor)) return;
+
+	Pool.Stats.Class = Actor->GetClass();
+	Pool.InUse.Remove(Actor);
+	++Pool.Stats.NumReleased;
+
+	Park(Actor);
+	Pool.AddFree(Actor);
+}
+
+void UActorPoolSubsystem::ReleaseOrDestroy(AActor* Actor)
+{
+	if (!IsValid(Actor)) return;
+
+	UWorld* World = Actor->GetWorld();
+	if (UActorPoolSubsystem* Pool = World ? World->GetSubsystem<UActorPoolSubsystem>() : nullptr)
+	{
+		Pool->Release(Actor);
+	}
+	else
+	{
+		Actor->Destroy();
+	}
+}
+
+FActorPoolStats UActorPoolSubsystem::GetStats(TSubclassOf<AActor> Class) const
+{
+	const FActorPool* Pool = Pools.Find(Class.Get());
+	if (!Pool) return FActorPoolStats();
+
+	FActorPoolStats Stats = Pool->Stats;
+	Stats.NumFree = Pool->Free.Num();
+	Stats.NumInUse = Pool->InUse.Num();
+	return Stats;
+}
+
+TArray<FActorPoolStats> UActorPoolSubsystem::GetAllStats() const
+{
+	TArray<FActorPoolStats> AllStats;
+	AllStats.Reserve(Pools.Num());
+
+	for (const TPair<TObjectPtr<UClass>, FActorPool>& Pair : Pools)
+	{
+		AllStats.Add(GetStats(Pair.Key.Get()));
+	}
+	return AllStats;
+}
+
+void UActorPoolSubsystem::DumpStats() const
+{
+	for (const FActorPoolStats& Stats : GetAllStats())
+	{
+		UE_LOG(Logmaterial, Display, TEXT("pool %s: free %d, in use %d, peak %d, spawned %d (%d on empty pool), acquired %d, released %d"),
+			*GetNameSafe(Stats.Class), Stats.NumFree, Stats.NumInUse, Stats.PeakInUse, Stats.NumSpawned, Stats.NumMisses, Stats.NumAcquired, Stats.NumReleased);
+	}
+}
+
+AActor* UActorPoolSubsystem::SpawnPooled(UClass* Class, const FTransform& Transform)
+{
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return GetWorld()->SpawnActor<AActor>(Class, Transform, Params);
+}
+
+void UActorPoolSubsystem::Park(AActor* Actor)
+{
+	if (IPooledActor* Pooled = Cast<IPooledActor>(Actor))
+	{
+		Pooled->OnReturnedToPool();
+	}
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	Actor->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	Actor->SetOwner(nullptr);
+}
+
+void UActorPoolSubsystem::Unpark(AActor* Actor, const FTransform& Transform)
+{
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+
+	if (IPooledActor* Pooled = Cast<IPooledActor>(Actor))
+	{
+		Pooled->OnAcquiredFromPool();
+	}
+}
@@ -0,0 +1,153 @@
+// ActorPoolSubsystem.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "ActorPoolSubsystem.generated.h"
+
+/**
+ *  PooledActor interface
+ */
+UINTERFACE(MinimalAPI)
+class UPooledActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ *  Optional hooks for actors recycled through UActorPoolSubsystem.
+ */
+class IPooledActor
+{
+	GENERATED_BODY()
+
+public:
+
+	/** The actor was taken out of the pool, shown and moved to its new transform. State should be reset to spec here */
+	virtual void OnAcquiredFromPool() {}
+
+	/** The actor was hidden and parked in the pool. Timers, registrations and attachments should be dropped here */
+	virtual void OnReturnedToPool() {}
+};
+
+/** Usage of one class pool, for sizing the pre-warm counts of a level */
+USTRUCT(BlueprintType)
+struct FActorPoolStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Pool")
+	TObjectPtr<UClass> Class;
+
+	/** Parked and ready for reuse */
+	UPROPERTY(BlueprintReadOnly, Category="Pool")
+	int32 NumFree = 0;
+
+	/** Handed out and not released yet */
+	UPROPERTY(BlueprintReadOnly, Category="Pool")
+	int32 NumInUse = 0;
+
+	/** Most actors in use at once. Pre-warming this many avoids every spawn after the first frame */
+	UPROPERTY(BlueprintReadOnly, Category="Pool")
+	int32 PeakInUse = 0;
+
+	/** Actors spawned by the pool, pre-warmed or on an empty pool */
+	UPROPERTY(BlueprintReadOnly, Category="Pool")
+	int32 NumSpawned = 0;
+
+	/** Spawns that happened because the pool was empty */
+	UPROPERTY(BlueprintReadOnly, Category="Pool")
+	int32 NumMisses = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Pool")
+	int32 NumAcquired = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="Pool")
+	int32 NumReleased = 0;
+};
+
+/** Parked actors of one class */
+USTRUCT()
+struct FActorPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<AActor>> Free;
+
+	/** Slot of each parked actor in Free, so lookups and removals by actor do not scan */
+	TMap<TObjectKey<AActor>, int32> FreeIndices;
+
+	/** Handed out by this pool and not released yet, so released level actors can be told apart */
+	TSet<TWeakObjectPtr<AActor>> InUse;
+
+	FActorPoolStats Stats;
+
+	void AddFree(AActor* Actor);
+	AActor* PopFree();
+	bool RemoveFree(const AActor* Actor);
+	bool IsFree(const AActor* Actor) const { return FreeIndices.Contains(Actor); }
+};
+
+/**
+ *  Keeps spawned actors around instead of destroying them, so bursts of short-lived actors
+ *  (puddles, vapour, melted or reset puzzle blocks) do not cause spawn hitches or GC spikes.
+ *  Pooled actors are hidden, without collision and not ticking. Level-placed actors may be released too,
+ *  and are reused like any other afterwards.
+ */
+UCLASS()
+class MATERIAL_API UActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	/** Spawns actors of the class until at least Count of them are parked in the pool */
+	UFUNCTION(BlueprintCallable, Category="Pool")
+	void Prewarm(TSubclassOf<AActor> Class, int32 Count);
+
+	/** Takes a parked actor of exactly this class, or spawns a new one if the pool is empty */
+	UFUNCTION(BlueprintCallable, Category="Pool", meta=(DeterminesOutputType="Class"))
+	AActor* Acquire(TSubclassOf<AActor> Class, const FTransform& Transform);
+
+	template<typename T>
+	T* AcquireAs(TSubclassOf<T> Class, const FTransform& Transform)
+	{
+		return Cast<T>(Acquire(TSubclassOf<AActor>(Class.Get()), Transform));
+	}
+
+	/** Takes this particular actor back out of the pool, e.g. a block restored by a checkpoint. False if it was not parked */
+	bool Reclaim(AActor* Actor, const FTransform& Transform);
+
+	/** True while the actor sits in the pool */
+	bool IsParked(const AActor* Actor) const;
+
+	/** Parks the actor for reuse instead of destroying it */
+	UFUNCTION(BlueprintCallable, Category="Pool")
+	void Release(AActor* Actor);
+
+	/** Releases the actor, or destroys it when the world has no pool */
+	static void ReleaseOrDestroy(AActor* Actor);
+
+	UFUNCTION(BlueprintPure, Category="Pool")
+	FActorPoolStats GetStats(TSubclassOf<AActor> Class) const;
+
+	UFUNCTION(BlueprintPure, Category="Pool")
+	TArray<FActorPoolStats> GetAllStats() const;
+
+	/** Writes every pool's stats to the log */
+	void DumpStats() const;
+
+private:
+
+	AActor* SpawnPooled(UClass* Class, const FTransform& Transform);
+	void Park(AActor* Actor);
+	void Unpark(AActor* Actor, const FTransform& Transform);
+
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UClass>, FActorPool> Pools;
+};
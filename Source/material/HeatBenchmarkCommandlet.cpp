@@ -0,0 +1,271 @@
+// HeatBenchmarkCommandlet.cpp
+
+#include "HeatBenchmarkCommandlet.h"
+
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "Components/StaticMeshComponent.h"
+#include "EngineUtils.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Ice.h"
+#include "Transformation_actor.h"
+#include "Temperature.h"
+#include "material.h"
+
+#include <atomic>
+
+namespace HeatBenchmark
+{
+	/** Counts allocations going through GMalloc while installed, forwarding everything to the real allocator */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+
+		explicit FCountingMalloc(FMalloc* InInner) : Inner(InInner) {}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			NumAllocs.fetch_add(1, std::memory_order_relaxed);
+			NumBytes.fetch_add(Count, std::memory_order_relaxed);
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			NumAllocs.fetch_add(1, std::memory_order_relaxed);
+			NumBytes.fetch_add(Count, std::memory_order_relaxed);
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			NumAllocs.fetch_add(1, std::memory_order_relaxed);
+			NumBytes.fetch_add(Count, std::memory_order_relaxed);
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			NumAllocs.fetch_add(1, std::memory_order_relaxed);
+			NumBytes.fetch_add(Count, std::memory_order_relaxed);
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void MarkTLSCachesAsUsedOnCurrentThread() override { Inner->MarkTLSCachesAsUsedOnCurrentThread(); }
+		virtual void MarkTLSCachesAsUnusedOnCurrentThread() override { Inner->MarkTLSCachesAsUnusedOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+		FMalloc* Inner;
+		std::atomic<uint64> NumAllocs { 0 };
+		std::atomic<uint64> NumBytes { 0 };
+	};
+
+	/** One CSV row */
+	struct FFrameSample
+	{
+		double FrameMs;
+		int32 TickFunctions;
+		uint64 Allocs;
+		uint64 AllocBytes;
+	};
+}
+
+UHeatBenchmarkCommandlet::UHeatBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UHeatBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace HeatBenchmark;
+
+	int32 NumFrames = 600;
+	int32 NumWarmup = 30;
+	float FrameTime = 1.0f / 60.0f;
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmark") / TEXT("HeatBenchmark.csv");
+
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("Warmup="), NumWarmup);
+	FParse::Value(*Params, TEXT("FrameTime="), FrameTime);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	NumFrames = FMath::Max(NumFrames, 1);
+	NumWarmup = FMath::Max(NumWarmup, 0);
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("HeatBenchmark"));
+	FWorldContext& Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+	Context.SetCurrentWorld(World);
+
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	// no game mode in this world, so actors are started directly
+	World->GetWorldSettings()->NotifyBeginPlay();
+
+	SpawnScene(World, Params);
+
+	for (int32 i = 0; i < NumWarmup; ++i)
+	{
+		World->Tick(LEVELTICK_All, FrameTime);
+	}
+
+	// installed only around the measured frames, everything is forwarded to the real allocator
+	static FCountingMalloc* CountingMalloc = nullptr;
+	if (!CountingMalloc)
+	{
+		CountingMalloc = new FCountingMalloc(GMalloc);
+	}
+	FMalloc* PreviousMalloc = GMalloc;
+	GMalloc = CountingMalloc;
+
+	TArray<FFrameSample> Samples;
+	Samples.Reserve(NumFrames);
+
+	for (int32 i = 0; i < NumFrames; ++i)
+	{
+		const uint64 AllocsBefore = CountingMalloc->NumAllocs.load(std::memory_order_relaxed);
+		const uint64 BytesBefore = CountingMalloc->NumBytes.load(std::memory_order_relaxed);
+		const double Start = FPlatformTime::Seconds();
+
+		World->Tick(LEVELTICK_All, FrameTime);
+
+		const double FrameMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+		const uint64 Allocs = CountingMalloc->NumAllocs.load(std::memory_order_relaxed) - AllocsBefore;
+		const uint64 AllocBytes = CountingMalloc->NumBytes.load(std::memory_order_relaxed) - BytesBefore;
+
+		// between the counter reads, so the walk's own allocations and time are not charged to any frame
+		const int32 TickFunctions = CountTickFunctions(World);
+
+		Samples.Add({ FrameMs, TickFunctions, Allocs, AllocBytes });
+	}
+
+	GMalloc = PreviousMalloc;
+
+	FString Csv = TEXT("Frame,FrameMs,TickFunctions,Allocs,AllocBytes\n");
+	TArray<double> SortedMs;
+	SortedMs.Reserve(Samples.Num());
+	uint64 TotalAllocs = 0;
+	int32 PeakTickFunctions = 0;
+
+	for (int32 i = 0; i < Samples.Num(); ++i)
+	{
+		const FFrameSample& Sample = Samples[i];
+		Csv += FString::Printf(TEXT("%d,%.4f,%d,%llu,%llu\n"), i, Sample.FrameMs, Sample.TickFunctions, Sample.Allocs, Sample.AllocBytes);
+		SortedMs.Add(Sample.FrameMs);
+		TotalAllocs += Sample.Allocs;
+		PeakTickFunctions = FMath::Max(PeakTickFunctions, Sample.TickFunctions);
+	}
+
+	SortedMs.Sort();
+	double SumMs = 0.0;
+	for (const double Ms : SortedMs)
+	{
+		SumMs += Ms;
+	}
+
+	UE_LOG(Logmaterial, Display, TEXT("HeatBenchmark: %d frames, avg %.3f ms, p50 %.3f ms, p95 %.3f ms, max %.3f ms, up to %d tick functions, %.1f allocs/frame"),
+		SortedMs.Num(), SumMs / SortedMs.Num(), SortedMs[SortedMs.Num() / 2], SortedMs[FMath::Min(FMath::FloorToInt32(SortedMs.Num() * 0.95), SortedMs.Num() - 1)],
+		SortedMs.Last(), PeakTickFunctions, static_cast<double>(TotalAllocs) / SortedMs.Num());
+
+	const bool bSaved = FFileHelper::SaveStringToFile(Csv, *OutputPath);
+	if (bSaved)
+	{
+		UE_LOG(Logmaterial, Display, TEXT("HeatBenchmark: wrote %s"), *OutputPath);
+	}
+	else
+	{
+		UE_LOG(Logmaterial, Error, TEXT("HeatBenchmark: could not write %s"), *OutputPath);
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return bSaved ? 0 : 1;
+}
+
+void UHeatBenchmarkCommandlet::SpawnScene(UWorld* World, const FString& Params) const
+{
+	int32 GridX = 16;
+	int32 GridY = 16;
+	int32 NumSources = 4;
+	float Spacing = 150.0f;
+	float SourceTemperature = 600.0f;
+	FString BlockType = TEXT("Ice");
+
+	FParse::Value(*Params, TEXT("GridX="), GridX);
+	FParse::Value(*Params, TEXT("GridY="), GridY);
+	FParse::Value(*Params, TEXT("Sources="), NumSources);
+	FParse::Value(*Params, TEXT("Spacing="), Spacing);
+	FParse::Value(*Params, TEXT("Temperature="), SourceTemperature);
+	FParse::Value(*Params, TEXT("Block="), BlockType);
+
+	// engine content, so the benchmark does not depend on project assets
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	const bool bTransformation = BlockType.Equals(TEXT("Transformation"), ESearchCase::IgnoreCase);
+
+	for (int32 Y = 0; Y < GridY; ++Y)
+	{
+		for (int32 X = 0; X < GridX; ++X)
+		{
+			const FTransform Transform(FVector(X * Spacing, Y * Spacing, 50.0f));
+
+			if (bTransformation)
+			{
+				ATransformation_actor* Block = World->SpawnActorDeferred<ATransformation_actor>(ATransformation_actor::StaticClass(), Transform);
+				Block->MeshComp->SetStaticMesh(Cube);
+				Block->bDebugMelt = false;
+				Block->FinishSpawning(Transform);
+			}
+			else
+			{
+				AIce* Block = World->SpawnActorDeferred<AIce>(AIce::StaticClass(), Transform);
+				Block->MeshComp->SetStaticMesh(Cube);
+				Block->bDebugMelt = false;
+				Block->FinishSpawning(Transform);
+			}
+		}
+	}
+
+	// a row of sources through the middle of the grid
+	const float Width = FMath::Max(GridX - 1, 0) * Spacing;
+	for (int32 i = 0; i < NumSources; ++i)
+	{
+		const FVector Location((i + 0.5f) / NumSources * Width, (GridY - 1) * Spacing * 0.5f, 100.0f);
+		ATemperature* Source = World->SpawnActor<ATemperature>(ATemperature::StaticClass(), FTransform(Location));
+		Source->SetTemperature(SourceTemperature);
+	}
+
+	UE_LOG(Logmaterial, Display, TEXT("HeatBenchmark: %d %s blocks, %d sources"), GridX * GridY, bTransformation ? TEXT("transformation") : TEXT("ice"), NumSources);
+}
+
+int32 UHeatBenchmarkCommandlet::CountTickFunctions(UWorld* World)
+{
+	int32 Count = 0;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		Count += It->IsActorTickEnabled() ? 1 : 0;
+
+		for (const UActorComponent* Component : It->GetComponents())
+		{
+			Count += Component && Component->IsComponentTickEnabled() ? 1 : 0;
+		}
+	}
+	return Count;
+}
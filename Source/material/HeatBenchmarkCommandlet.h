@@ -0,0 +1,33 @@
+// HeatBenchmarkCommandlet.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "HeatBenchmarkCommandlet.generated.h"
+
+/**
+ *  Headless thermal stress benchmark. Builds an empty game world, spawns a grid of ice blocks around a row of
+ *  heat sources and ticks it for a fixed number of frames, writing frame time, tick functions and allocations as CSV.
+ *  Needs no GPU:
+ *
+ *    UnrealEditor-Cmd material.uproject -run=HeatBenchmark -nullrhi -unattended
+ *      [-Block=Ice|Transformation] [-GridX=16] [-GridY=16] [-Spacing=150] [-Sources=4]
+ *      [-Frames=600] [-Warmup=30] [-FrameTime=0.0166] [-Output=Saved/Benchmark/HeatBenchmark.csv]
+ */
+UCLASS()
+class UHeatBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UHeatBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	void SpawnScene(UWorld* World, const FString& Params) const;
+	static int32 CountTickFunctions(UWorld* World);
+};
@@ -0,0 +1,293 @@
+// HeatFluxKernel.cpp
+
+#include "HeatFluxKernel.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "material.h"
+
+static TAutoConsoleVariable<int32> CVarHeatSIMDFlux(
+	TEXT("heat.SIMDFlux"),
+	1,
+	TEXT("1 evaluates radiant flux four pairs at a time, 0 uses the scalar reference path."),
+	ECVF_Default);
+
+void FHeatPairBatch::Reset()
+{
+	SourceX.Reset();
+	SourceY.Reset();
+	SourceZ.Reset();
+	ReceiverX.Reset();
+	ReceiverY.Reset();
+	ReceiverZ.Reset();
+	SourcePowerW.Reset();
+	MaxDistCm.Reset();
+	ReceiverAreaM2.Reset();
+}
+
+void FHeatPairBatch::Add(const FVector& SourceLocation, const FVector& ReceiverLocation, float PowerW, float MaxDist, float AreaM2)
+{
+	SourceX.Add(static_cast<float>(SourceLocation.X));
+	SourceY.Add(static_cast<float>(SourceLocation.Y));
+	SourceZ.Add(static_cast<float>(SourceLocation.Z));
+	ReceiverX.Add(static_cast<float>(ReceiverLocation.X));
+	ReceiverY.Add(static_cast<float>(ReceiverLocation.Y));
+	ReceiverZ.Add(static_cast<float>(ReceiverLocation.Z));
+	SourcePowerW.Add(PowerW);
+	MaxDistCm.Add(MaxDist);
+	ReceiverAreaM2.Add(AreaM2);
+}
+
+float HeatFlux::ReceivedPowerW(float DistCm, float SourcePowerW, float MaxDistCm, float ReceiverAreaM2)
+{
+	const float DistM = FMath::Max(DistCm / 100.0f, MinDistanceM);
+	const float HeatFluxWm2 = SourcePowerW / (4.0f * PI * DistM * DistM);
+	float PowerW = HeatFluxWm2 * ReceiverAreaM2;
+
+	if (MaxDistCm > 0.0f)
+	{
+		PowerW *= FMath::Clamp(1.0f - (DistCm / MaxDistCm), 0.0f, 1.0f);
+	}
+
+	return FMath::Max(PowerW, 0.0f);
+}
+
+void HeatFlux::ComputeReceivedPowerScalar(const FHeatPairBatch& Batch, TArrayView<float> OutPowerW, TArrayView<float> OutDistCm)
+{
+	const int32 Num = Batch.Num();
+	check(OutPowerW.Num() >= Num && OutDistCm.Num() >= Num);
+
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const float Dx = Batch.ReceiverX[i] - Batch.SourceX[i];
+		const float Dy = Batch.ReceiverY[i] - Batch.SourceY[i];
+		const float Dz = Batch.ReceiverZ[i] - Batch.SourceZ[i];
+		const float DistCm = FMath::Sqrt(Dx * Dx + Dy * Dy + Dz * Dz);
+
+		OutDistCm[i] = DistCm;
+		OutPowerW[i] = ReceivedPowerW(DistCm, Batch.SourcePowerW[i], Batch.MaxDistCm[i], Batch.ReceiverAreaM2[i]);
+	}
+}
+
+void HeatFlux::ComputeReceivedPowerSIMD(const FHeatPairBatch& Batch, TArrayView<float> OutPowerW, TArrayView<float> OutDistCm)
+{
+	const int32 Num = Batch.Num();
+	check(OutPowerW.Num() >= Num && OutDistCm.Num() >= Num);
+
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float One = VectorOneFloat();
+	const VectorRegister4Float CmToM = VectorSetFloat1(0.01f);
+	const VectorRegister4Float MinDist = VectorSetFloat1(MinDistanceM);
+	const VectorRegister4Float FourPi = VectorSetFloat1(4.0f * PI);
+
+	const int32 NumVector = Num & ~3;
+	for (int32 i = 0; i < NumVector; i += 4)
+	{
+		const VectorRegister4Float Dx = VectorSubtract(VectorLoad(&Batch.ReceiverX[i]), VectorLoad(&Batch.SourceX[i]));
+		const VectorRegister4Float Dy = VectorSubtract(VectorLoad(&Batch.ReceiverY[i]), VectorLoad(&Batch.SourceY[i]));
+		const VectorRegister4Float Dz = VectorSubtract(VectorLoad(&Batch.ReceiverZ[i]), VectorLoad(&Batch.SourceZ[i]));
+
+		const VectorRegister4Float DistSq = VectorMultiplyAdd(Dz, Dz, VectorMultiplyAdd(Dy, Dy, VectorMultiply(Dx, Dx)));
+		const VectorRegister4Float DistCm = VectorSqrt(DistSq);
+
+		// inverse-square spread of the source power
+		const VectorRegister4Float DistM = VectorMax(VectorMultiply(DistCm, CmToM), MinDist);
+		const VectorRegister4Float Den = VectorMultiply(FourPi, VectorMultiply(DistM, DistM));
+		const VectorRegister4Float Flux = VectorDivide(VectorLoad(&Batch.SourcePowerW[i]), Den);
+		VectorRegister4Float Power = VectorMultiply(Flux, VectorLoad(&Batch.ReceiverAreaM2[i]));
+
+		// linear fade, only for sources with a finite range
+		const VectorRegister4Float MaxDist = VectorLoad(&Batch.MaxDistCm[i]);
+		const VectorRegister4Float HasRange = VectorCompareGT(MaxDist, Zero);
+		const VectorRegister4Float SafeMaxDist = VectorSelect(HasRange, MaxDist, One);
+		const VectorRegister4Float Fade = VectorMin(VectorMax(VectorSubtract(One, VectorDivide(DistCm, SafeMaxDist)), Zero), One);
+		Power = VectorMultiply(Power, VectorSelect(HasRange, Fade, One));
+
+		VectorStore(VectorMax(Power, Zero), &OutPowerW[i]);
+		VectorStore(DistCm, &OutDistCm[i]);
+	}
+
+	for (int32 i = NumVector; i < Num; ++i)
+	{
+		const float Dx = Batch.ReceiverX[i] - Batch.SourceX[i];
+		const float Dy = Batch.ReceiverY[i] - Batch.SourceY[i];
+		const float Dz = Batch.ReceiverZ[i] - Batch.SourceZ[i];
+		const float DistCm = FMath::Sqrt(Dx * Dx + Dy * Dy + Dz * Dz);
+
+		OutDistCm[i] = DistCm;
+		OutPowerW[i] = ReceivedPowerW(DistCm, Batch.SourcePowerW[i], Batch.MaxDistCm[i], Batch.ReceiverAreaM2[i]);
+	}
+}
+
+void HeatFlux::ComputeReceivedPower(const FHeatPairBatch& Batch, TArrayView<float> OutPowerW, TArrayView<float> OutDistCm)
+{
+	if (CVarHeatSIMDFlux.GetValueOnGameThread() != 0)
+	{
+		ComputeReceivedPowerSIMD(Batch, OutPowerW, OutDistCm);
+	}
+	else
+	{
+		ComputeReceivedPowerScalar(Batch, OutPowerW, OutDistCm);
+	}
+}
+
+double HeatFlux::AnalyticEnergyJ(TConstArrayView<FHeatAnalyticTerm> Terms, double Seconds)
+{
+	if (Seconds <= 0.0) return 0.0;
+
+	constexpr double ZeroCelsiusK = 273.15;
+
+	double EnergyJ = 0.0;
+	for (const FHeatAnalyticTerm& Term : Terms)
+	{
+		const double Scale = static_cast<double>(Term.Coupling) * Term.RadiantCoeff;
+		const double StartK = static_cast<double>(Term.StartTemperatureC) + ZeroCelsiusK;
+		const double Rate = Term.CoolRate;
+
+		if (Rate <= 0.0 || Term.StartTemperatureC <= 0.0f)
+		{
+			EnergyJ += Scale * FMath::Pow(StartK, 4.0) * Seconds;
+			continue;
+		}
+
+		// integral of (K0 - r t)^4 is (K0^5 - (K0 - r t)^5) / 5r, constant at 0 C after the source has cooled down
+		const double CooledAt = Term.StartTemperatureC / Rate;
+		const double CoolingTime = FMath::Min(Seconds, CooledAt);
+		const double EndK = StartK - Rate * CoolingTime;
+
+		double Integral = (FMath::Pow(StartK, 5.0) - FMath::Pow(EndK, 5.0)) / (5.0 * Rate);
+		if (Seconds > CooledAt)
+		{
+			Integral += FMath::Pow(ZeroCelsiusK, 4.0) * (Seconds - CooledAt);
+		}
+
+		EnergyJ += Scale * Integral;
+	}
+
+	return EnergyJ;
+}
+
+double HeatFlux::SolveAnalyticTime(TConstArrayView<FHeatAnalyticTerm> Terms, double RequiredJ)
+{
+	if (RequiredJ <= 0.0) return 0.0;
+
+	// energy only ever grows, so bracket the root by doubling and then bisect
+	double Low = 0.0;
+	double High = 1.0;
+	while (AnalyticEnergyJ(Terms, High) < RequiredJ)
+	{
+		Low = High;
+		High *= 2.0;
+		if (High > 1.0e9) return -1.0;
+	}
+
+	for (int32 Iteration = 0; Iteration < 64 && (High - Low) > 1.0e-4; ++Iteration)
+	{
+		const double Mid = 0.5 * (Low + High);
+		if (AnalyticEnergyJ(Terms, Mid) < RequiredJ)
+		{
+			Low = Mid;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	return High;
+}
+
+#if !UE_BUILD_SHIPPING || WITH_DEV_AUTOMATION_TESTS
+
+namespace HeatFluxVerify
+{
+	/** Random pairs around the origin. Every seventh source has no range limit, every eleventh receiver sits on its source */
+	void MakeRandomBatch(FRandomStream& Rand, int32 NumPairs, FHeatPairBatch& OutBatch)
+	{
+		OutBatch.Reset();
+		for (int32 i = 0; i < NumPairs; ++i)
+		{
+			const FVector Source = Rand.GetUnitVector() * Rand.FRandRange(0.0f, 2000.0f);
+			const FVector Receiver = (i % 11 == 0) ? Source : Source + Rand.GetUnitVector() * Rand.FRandRange(0.0f, 800.0f);
+			const float MaxDist = (i % 7 == 0) ? 0.0f : Rand.FRandRange(100.0f, 800.0f);
+			OutBatch.Add(Source, Receiver, Rand.FRandRange(100.0f, 50000.0f), MaxDist, Rand.FRandRange(0.01f, 4.0f));
+		}
+	}
+
+	/** Largest relative disagreement between the SIMD and scalar paths over power and distance */
+	float MaxRelativeError(const FHeatPairBatch& Batch)
+	{
+		const int32 NumPairs = Batch.Num();
+
+		TArray<float> ScalarPower, ScalarDist, SIMDPower, SIMDDist;
+		ScalarPower.SetNumZeroed(NumPairs);
+		ScalarDist.SetNumZeroed(NumPairs);
+		SIMDPower.SetNumZeroed(NumPairs);
+		SIMDDist.SetNumZeroed(NumPairs);
+
+		HeatFlux::ComputeReceivedPowerScalar(Batch, ScalarPower, ScalarDist);
+		HeatFlux::ComputeReceivedPowerSIMD(Batch, SIMDPower, SIMDDist);
+
+		float MaxError = 0.0f;
+		for (int32 i = 0; i < NumPairs; ++i)
+		{
+			MaxError = FMath::Max(MaxError, FMath::Abs(SIMDPower[i] - ScalarPower[i]) / FMath::Max(FMath::Abs(ScalarPower[i]), 1e-3f));
+			MaxError = FMath::Max(MaxError, FMath::Abs(SIMDDist[i] - ScalarDist[i]) / FMath::Max(ScalarDist[i], 1e-3f));
+		}
+		return MaxError;
+	}
+
+	constexpr float Tolerance = 1e-4f;
+}
+
+#endif
+
+#if !UE_BUILD_SHIPPING
+
+/** Runs both kernel paths over random pairs and reports the largest disagreement */
+static FAutoConsoleCommand CmdHeatVerifyFluxKernel(
+	TEXT("heat.VerifyFluxKernel"),
+	TEXT("Compares the SIMD and scalar radiant flux kernels on random pairs. Optional arg: pair count."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumPairs = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 4099;
+
+		FRandomStream Rand(1234);
+		FHeatPairBatch Batch;
+		HeatFluxVerify::MakeRandomBatch(Rand, NumPairs, Batch);
+
+		const float MaxRelError = HeatFluxVerify::MaxRelativeError(Batch);
+		const bool bAgree = MaxRelError <= HeatFluxVerify::Tolerance;
+		UE_LOG(Logmaterial, Display, TEXT("heat.VerifyFluxKernel: %d pairs, max relative error %g -> %s"),
+			NumPairs, MaxRelError, bAgree ? TEXT("OK") : TEXT("MISMATCH"));
+	}));
+
+#endif
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHeatFluxKernelTest, "MaterialSim.HeatFlux.SIMDMatchesScalar",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FHeatFluxKernelTest::RunTest(const FString& Parameters)
+{
+	// odd lengths leave one to three pairs for the scalar tail after the four-wide loop
+	const int32 Lengths[] = { 0, 1, 2, 3, 4, 5, 6, 7, 9, 13, 31, 257, 4099 };
+
+	FRandomStream Rand(0x4845);
+	FHeatPairBatch Batch;
+	for (const int32 NumPairs : Lengths)
+	{
+		HeatFluxVerify::MakeRandomBatch(Rand, NumPairs, Batch);
+
+		const float MaxError = HeatFluxVerify::MaxRelativeError(Batch);
+		TestTrue(FString::Printf(TEXT("%d pairs agree within %g (max relative error %g)"), NumPairs, HeatFluxVerify::Tolerance, MaxError),
+			MaxError <= HeatFluxVerify::Tolerance);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,70 @@
+// HeatFluxKernel.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ *  Flat source/receiver pair arrays fed to the radiant flux kernel.
+ *  Every array has the same length; one entry per pair.
+ */
+struct FHeatPairBatch
+{
+	TArray<float> SourceX;
+	TArray<float> SourceY;
+	TArray<float> SourceZ;
+	TArray<float> ReceiverX;
+	TArray<float> ReceiverY;
+	TArray<float> ReceiverZ;
+	TArray<float> SourcePowerW;
+	TArray<float> MaxDistCm;
+	TArray<float> ReceiverAreaM2;
+
+	int32 Num() const { return SourcePowerW.Num(); }
+
+	void Reset();
+	void Add(const FVector& SourceLocation, const FVector& ReceiverLocation, float PowerW, float MaxDist, float AreaM2);
+};
+
+/**
+ *  One source term of an analytic melt prediction, snapshotted when the prediction is made.
+ *  The source cools linearly at CoolRate until 0 C and stays there.
+ */
+struct FHeatAnalyticTerm
+{
+	/** Received power per watt emitted, from distance, fade and receiver area */
+	float Coupling = 0.0f;
+
+	/** Emissivity * sigma * area of the source, P = RadiantCoeff * T_K^4 */
+	float RadiantCoeff = 0.0f;
+
+	float StartTemperatureC = 0.0f;
+	float CoolRate = 0.0f;
+};
+
+namespace HeatFlux
+{
+	/** Closest distance used for the inverse-square law, keeps the flux finite when a block touches the fire */
+	constexpr float MinDistanceM = 0.05f;
+
+	/**
+	 *  Received power of a single pair: Stefan-Boltzmann source power spread over 4*pi*r^2,
+	 *  times receiver area, times the linear fade towards MaxDistCm.
+	 */
+	float ReceivedPowerW(float DistCm, float SourcePowerW, float MaxDistCm, float ReceiverAreaM2);
+
+	/** Reference path, one pair at a time */
+	void ComputeReceivedPowerScalar(const FHeatPairBatch& Batch, TArrayView<float> OutPowerW, TArrayView<float> OutDistCm);
+
+	/** Four pairs per iteration using VectorRegister4Float; the tail falls back to the scalar path */
+	void ComputeReceivedPowerSIMD(const FHeatPairBatch& Batch, TArrayView<float> OutPowerW, TArrayView<float> OutDistCm);
+
+	/** Energy received over Seconds from every term, integrated in closed form */
+	double AnalyticEnergyJ(TConstArrayView<FHeatAnalyticTerm> Terms, double Seconds);
+
+	/** Seconds until AnalyticEnergyJ reaches RequiredJ, or a negative value if it never does */
+	double SolveAnalyticTime(TConstArrayView<FHeatAnalyticTerm> Terms, double RequiredJ);
+
+	/** Dispatches to the SIMD path unless heat.SIMDFlux is 0 */
+	void ComputeReceivedPower(const FHeatPairBatch& Batch, TArrayView<float> OutPowerW, TArrayView<float> OutDistCm);
+}
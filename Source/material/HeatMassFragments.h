@@ -0,0 +1,93 @@
+// HeatMassFragments.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "HeatMassFragments.generated.h"
+
+class IHeatInstancedReceiver;
+
+/** World location of a Mass heat receiver */
+USTRUCT()
+struct MATERIAL_API FHeatMassLocationFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FVector Location = FVector::ZeroVector;
+};
+
+/** Thermal body of a Mass heat receiver, the same numbers AIce derives from its mesh bounds */
+USTRUCT()
+struct MATERIAL_API FHeatMassBodyFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	float VolumeM3 = 1.0f;
+	float EffectiveAreaM2 = 1.0f;
+	float TotalMeltEnergyJ = 1.0f;
+	float SimTimeScale = 3600.0f;
+};
+
+/** Melt state and the power received on the last step */
+USTRUCT()
+struct MATERIAL_API FHeatMassStateFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	float EnergyJ = 0.0f;
+	float MeltAlpha = 0.0f;
+	float ReceivedPowerW = 0.0f;
+	float NearestDistCm = 0.0f;
+};
+
+/** Actor that renders the entity and receives its melt state, and the key the entity was created under */
+USTRUCT()
+struct MATERIAL_API FHeatMassOwnerFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	TWeakObjectPtr<AActor> Owner;
+	IHeatInstancedReceiver* Callbacks = nullptr;
+	int32 InstanceKey = INDEX_NONE;
+
+	/** Tested against ATemperature::IceClassFilter from worker threads, so kept as a raw class pointer */
+	const UClass* OwnerClass = nullptr;
+};
+
+/** Fully melted, skipped by the heat processors */
+USTRUCT()
+struct MATERIAL_API FHeatMassMeltedTag : public FMassTag
+{
+	GENERATED_BODY()
+};
+
+/** Heat sources as seen by the Mass processors, copied from UHeatSimSubsystem before each run */
+struct FHeatMassSourceSnapshot
+{
+	TArray<FVector> Locations;
+	TArray<float> PowerW;
+	TArray<float> MaxDistCm;
+	TArray<const UClass*> ClassFilters;
+
+	int32 Num() const { return Locations.Num(); }
+
+	void Reset()
+	{
+		Locations.Reset();
+		PowerW.Reset();
+		MaxDistCm.Reset();
+		ClassFilters.Reset();
+	}
+};
+
+/** Melt state of one entity, collected by the melt processor and applied to the owner after the run */
+struct FHeatMassApply
+{
+	FMassEntityHandle Entity;
+	FHeatMassOwnerFragment Owner;
+	float EnergyJ = 0.0f;
+	float Alpha = 0.0f;
+	float ReceivedPowerW = 0.0f;
+	float DistCm = 0.0f;
+};
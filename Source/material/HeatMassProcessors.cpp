@@ -0,0 +1,127 @@
+// HeatMassProcessors.cpp
+
+#include "HeatMassProcessors.h"
+
+#include "MassExecutionContext.h"
+#include "MassCommandBuffer.h"
+#include "HeatFluxKernel.h"
+#include "MaterialSimStats.h"
+
+UHeatMassRadiantProcessor::UHeatMassRadiantProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = false;
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::AllNetModes);
+}
+
+void UHeatMassRadiantProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FHeatMassLocationFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FHeatMassBodyFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FHeatMassOwnerFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FHeatMassStateFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FHeatMassMeltedTag>(EMassFragmentPresence::None);
+}
+
+void UHeatMassRadiantProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	MATERIALSIM_SCOPE(HeatMass_Radiant);
+
+	if (!Sources) return;
+
+	const FHeatMassSourceSnapshot& Snapshot = *Sources;
+
+	// sources are few, so every entity is simply tested against all of them
+	EntityQuery.ParallelForEachEntityChunk(Context, [&Snapshot](FMassExecutionContext& Context)
+	{
+		const TConstArrayView<FHeatMassLocationFragment> Locations = Context.GetFragmentView<FHeatMassLocationFragment>();
+		const TConstArrayView<FHeatMassBodyFragment> Bodies = Context.GetFragmentView<FHeatMassBodyFragment>();
+		const TConstArrayView<FHeatMassOwnerFragment> Owners = Context.GetFragmentView<FHeatMassOwnerFragment>();
+		const TArrayView<FHeatMassStateFragment> States = Context.GetMutableFragmentView<FHeatMassStateFragment>();
+
+		for (int32 i = 0; i < Context.GetNumEntities(); ++i)
+		{
+			float PowerW = 0.0f;
+			float NearestDistCm = TNumericLimits<float>::Max();
+
+			for (int32 Source = 0; Source < Snapshot.Num(); ++Source)
+			{
+				const float MaxDist = Snapshot.MaxDistCm[Source];
+				const float DistSq = static_cast<float>(FVector::DistSquared(Snapshot.Locations[Source], Locations[i].Location));
+				if (DistSq > FMath::Square(MaxDist)) continue;
+
+				const UClass* Filter = Snapshot.ClassFilters[Source];
+				if (Filter && !(Owners[i].OwnerClass && Owners[i].OwnerClass->IsChildOf(Filter))) continue;
+
+				const float DistCm = FMath::Sqrt(DistSq);
+				PowerW += HeatFlux::ReceivedPowerW(DistCm, Snapshot.PowerW[Source], MaxDist, Bodies[i].EffectiveAreaM2);
+				NearestDistCm = FMath::Min(NearestDistCm, DistCm);
+			}
+
+			States[i].ReceivedPowerW = PowerW;
+			States[i].NearestDistCm = PowerW > 0.0f ? NearestDistCm : 0.0f;
+		}
+	});
+}
+
+UHeatMassMeltProcessor::UHeatMassMeltProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = false;
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::AllNetModes);
+}
+
+void UHeatMassMeltProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FHeatMassBodyFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FHeatMassOwnerFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FHeatMassStateFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FHeatMassMeltedTag>(EMassFragmentPresence::None);
+}
+
+void UHeatMassMeltProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	MATERIALSIM_SCOPE(HeatMass_Melt);
+
+	const float DeltaTime = Context.GetDeltaTimeSeconds();
+
+	EntityQuery.ParallelForEachEntityChunk(Context, [this, DeltaTime](FMassExecutionContext& Context)
+	{
+		const TConstArrayView<FHeatMassBodyFragment> Bodies = Context.GetFragmentView<FHeatMassBodyFragment>();
+		const TConstArrayView<FHeatMassOwnerFragment> Owners = Context.GetFragmentView<FHeatMassOwnerFragment>();
+		const TArrayView<FHeatMassStateFragment> States = Context.GetMutableFragmentView<FHeatMassStateFragment>();
+
+		TArray<FHeatMassApply, TInlineAllocator<32>> ChunkApplies;
+
+		for (int32 i = 0; i < Context.GetNumEntities(); ++i)
+		{
+			FHeatMassStateFragment& State = States[i];
+			if (State.ReceivedPowerW <= 0.0f) continue;
+
+			const FHeatMassBodyFragment& Body = Bodies[i];
+			State.EnergyJ += State.ReceivedPowerW * DeltaTime * Body.SimTimeScale;
+			State.MeltAlpha = FMath::Clamp(State.EnergyJ / Body.TotalMeltEnergyJ, 0.0f, 1.0f);
+
+			const FMassEntityHandle Entity = Context.GetEntity(i);
+			if (State.MeltAlpha >= 1.0f)
+			{
+				Context.Defer().AddTag<FHeatMassMeltedTag>(Entity);
+			}
+
+			ChunkApplies.Add({ Entity, Owners[i], State.EnergyJ, State.MeltAlpha, State.ReceivedPowerW, State.NearestDistCm });
+		}
+
+		// one lock per chunk, not per entity
+		if (ChunkApplies.Num() > 0)
+		{
+			FScopeLock Lock(&AppliesLock);
+			Applies.Append(ChunkApplies);
+		}
+	});
+}
+
+TArray<FHeatMassApply> UHeatMassMeltProcessor::ConsumeApplies()
+{
+	FScopeLock Lock(&AppliesLock);
+	return MoveTemp(Applies);
+}
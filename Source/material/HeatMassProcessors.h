@@ -0,0 +1,64 @@
+// HeatMassProcessors.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "HeatMassFragments.h"
+#include "HeatMassProcessors.generated.h"
+
+/**
+ *  Sums the radiant power every source delivers to each Mass heat receiver, in parallel chunks.
+ *  Not registered with the Mass processing phases, UHeatSimSubsystem runs it inside its fixed step.
+ */
+UCLASS()
+class MATERIAL_API UHeatMassRadiantProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+
+	UHeatMassRadiantProcessor();
+
+	/** Set by UHeatSimSubsystem for the duration of a run */
+	const FHeatMassSourceSnapshot* Sources = nullptr;
+
+protected:
+
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+
+	FMassEntityQuery EntityQuery;
+};
+
+/**
+ *  Integrates the received power into melt energy, in parallel chunks, and collects the changed entities
+ *  so UHeatSimSubsystem can hand them to their owners on the game thread.
+ */
+UCLASS()
+class MATERIAL_API UHeatMassMeltProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+
+	UHeatMassMeltProcessor();
+
+	/** Returns the entities changed since the last call */
+	TArray<FHeatMassApply> ConsumeApplies();
+
+protected:
+
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+
+	FMassEntityQuery EntityQuery;
+
+	TArray<FHeatMassApply> Applies;
+	FCriticalSection AppliesLock;
+};
@@ -0,0 +1,202 @@
+// HeatNetworkSolver.cpp
+
+#include "HeatNetworkSolver.h"
+
+#include "Async/ParallelFor.h"
+#include "MaterialSimStats.h"
+
+namespace HeatNetwork
+{
+	/** Rows per worker task. Partial sums are kept per chunk, so results do not depend on scheduling */
+	constexpr int32 RowsPerChunk = 256;
+
+	template<typename BodyType>
+	void ForEachChunk(int32 Num, int32 MinRowsForParallel, BodyType&& Body)
+	{
+		const int32 NumChunks = FMath::DivideAndRoundUp(Num, RowsPerChunk);
+		const EParallelForFlags Flags = Num < MinRowsForParallel ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None;
+
+		ParallelFor(NumChunks, [&](int32 Chunk)
+		{
+			const int32 Begin = Chunk * RowsPerChunk;
+			Body(Begin, FMath::Min(Begin + RowsPerChunk, Num));
+		}, Flags);
+	}
+
+	double Dot(TConstArrayView<double> A, TConstArrayView<double> B, int32 MinRowsForParallel)
+	{
+		const int32 Num = A.Num();
+		TArray<double, TInlineAllocator<64>> Partial;
+		Partial.SetNumZeroed(FMath::DivideAndRoundUp(Num, RowsPerChunk));
+
+		ForEachChunk(Num, MinRowsForParallel, [&](int32 Begin, int32 End)
+		{
+			double Sum = 0.0;
+			for (int32 i = Begin; i < End; ++i)
+			{
+				Sum += A[i] * B[i];
+			}
+			Partial[Begin / RowsPerChunk] = Sum;
+		});
+
+		double Sum = 0.0;
+		for (const double Value : Partial)
+		{
+			Sum += Value;
+		}
+		return Sum;
+	}
+}
+
+void FHeatNetworkSystem::Reset(int32 NumNodes)
+{
+	Diagonal.Reset();
+	Diagonal.SetNumZeroed(NumNodes);
+	Rhs.Reset();
+	Rhs.SetNumZeroed(NumNodes);
+	Edges.Reset();
+}
+
+void FHeatNetworkSystem::AddCapacity(int32 Node, double CapacityOverDt, double Previous)
+{
+	Diagonal[Node] += CapacityOverDt;
+	Rhs[Node] += CapacityOverDt * Previous;
+}
+
+void FHeatNetworkSystem::AddFixedEdge(int32 Node, double Conductance, double Fixed)
+{
+	Diagonal[Node] += Conductance;
+	Rhs[Node] += Conductance * Fixed;
+}
+
+void FHeatNetworkSystem::AddEdge(int32 NodeA, int32 NodeB, double Conductance)
+{
+	Diagonal[NodeA] += Conductance;
+	Diagonal[NodeB] += Conductance;
+	Edges.Add({ NodeA, NodeB, Conductance });
+}
+
+void FHeatNetworkSystem::Finalize()
+{
+	const int32 N = Num();
+
+	// counting sort of both directions of every edge into rows
+	RowStart.Reset();
+	RowStart.SetNumZeroed(N + 1);
+	for (const FEdge& Edge : Edges)
+	{
+		++RowStart[Edge.A + 1];
+		++RowStart[Edge.B + 1];
+	}
+	for (int32 i = 0; i < N; ++i)
+	{
+		RowStart[i + 1] += RowStart[i];
+	}
+
+	Columns.SetNumUninitialized(RowStart[N], EAllowShrinking::No);
+	Values.SetNumUninitialized(RowStart[N], EAllowShrinking::No);
+
+	TArray<int32> Fill(RowStart.GetData(), N);
+	for (const FEdge& Edge : Edges)
+	{
+		Columns[Fill[Edge.A]] = Edge.B;
+		Values[Fill[Edge.A]++] = -Edge.Conductance;
+		Columns[Fill[Edge.B]] = Edge.A;
+		Values[Fill[Edge.B]++] = -Edge.Conductance;
+	}
+}
+
+void FHeatNetworkSystem::Multiply(TConstArrayView<double> X, TArrayView<double> Out, int32 MinRowsForParallel) const
+{
+	HeatNetwork::ForEachChunk(Num(), MinRowsForParallel, [&](int32 Begin, int32 End)
+	{
+		for (int32 i = Begin; i < End; ++i)
+		{
+			double Sum = Diagonal[i] * X[i];
+			for (int32 k = RowStart[i]; k < RowStart[i + 1]; ++k)
+			{
+				Sum += Values[k] * X[Columns[k]];
+			}
+			Out[i] = Sum;
+		}
+	});
+}
+
+HeatNetwork::FSolveResult HeatNetwork::SolveConjugateGradient(const FHeatNetworkSystem& System, TArray<double>& InOutX, double Tolerance, int32 MaxIterations, int32 MinRowsForParallel)
+{
+	MATERIALSIM_SCOPE(HeatNetwork_Solve);
+
+	FSolveResult Result;
+
+	const int32 N = System.Num();
+	check(InOutX.Num() == N);
+	if (N == 0)
+	{
+		Result.bConverged = true;
+		return Result;
+	}
+
+	TArray<double> R;
+	TArray<double> Z;
+	TArray<double> P;
+	TArray<double> AP;
+	R.SetNumUninitialized(N);
+	Z.SetNumUninitialized(N);
+	P.SetNumUninitialized(N);
+	AP.SetNumUninitialized(N);
+
+	System.Multiply(InOutX, AP, MinRowsForParallel);
+	ForEachChunk(N, MinRowsForParallel, [&](int32 Begin, int32 End)
+	{
+		for (int32 i = Begin; i < End; ++i)
+		{
+			R[i] = System.Rhs[i] - AP[i];
+			Z[i] = R[i] / System.Diagonal[i];
+			P[i] = Z[i];
+		}
+	});
+
+	const double NormB = FMath::Max(FMath::Sqrt(Dot(System.Rhs, System.Rhs, MinRowsForParallel)), UE_DOUBLE_SMALL_NUMBER);
+	const double Threshold = Tolerance * NormB;
+
+	double RZ = Dot(R, Z, MinRowsForParallel);
+	double NormR = FMath::Sqrt(Dot(R, R, MinRowsForParallel));
+
+	while (Result.Iterations < MaxIterations && NormR > Threshold)
+	{
+		System.Multiply(P, AP, MinRowsForParallel);
+
+		const double PAP = Dot(P, AP, MinRowsForParallel);
+		if (PAP <= 0.0) break;
+
+		const double Alpha = RZ / PAP;
+		ForEachChunk(N, MinRowsForParallel, [&](int32 Begin, int32 End)
+		{
+			for (int32 i = Begin; i < End; ++i)
+			{
+				InOutX[i] += Alpha * P[i];
+				R[i] -= Alpha * AP[i];
+				Z[i] = R[i] / System.Diagonal[i];
+			}
+		});
+
+		NormR = FMath::Sqrt(Dot(R, R, MinRowsForParallel));
+		const double NewRZ = Dot(R, Z, MinRowsForParallel);
+		const double Beta = NewRZ / RZ;
+		RZ = NewRZ;
+
+		ForEachChunk(N, MinRowsForParallel, [&](int32 Begin, int32 End)
+		{
+			for (int32 i = Begin; i < End; ++i)
+			{
+				P[i] = Z[i] + Beta * P[i];
+			}
+		});
+
+		++Result.Iterations;
+	}
+
+	Result.RelativeResidual = NormR / NormB;
+	Result.bConverged = NormR <= Threshold;
+	return Result;
+}
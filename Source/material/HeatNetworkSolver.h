@@ -0,0 +1,68 @@
+// HeatNetworkSolver.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ *  Linear system of one backward-Euler step of a thermal network, A * T = b with one row per free node.
+ *  Nodes with a fixed temperature (sources, ambient, room voxels) are folded into the diagonal and b,
+ *  so A is symmetric positive definite and stored as compressed sparse rows once Finalize has run.
+ */
+struct FHeatNetworkSystem
+{
+	TArray<double> Diagonal;
+	TArray<double> Rhs;
+
+	TArray<int32> RowStart;
+	TArray<int32> Columns;
+	TArray<double> Values;
+
+	int32 Num() const { return Diagonal.Num(); }
+	int32 NumEdges() const { return Edges.Num(); }
+
+	void Reset(int32 NumNodes);
+
+	/** Heat capacity over the step: C / dt keeps the node at Previous when nothing else pulls on it */
+	void AddCapacity(int32 Node, double CapacityOverDt, double Previous);
+
+	/** Conductance G in W/K to a node held at Fixed */
+	void AddFixedEdge(int32 Node, double Conductance, double Fixed);
+
+	/** Conductance G in W/K between two free nodes */
+	void AddEdge(int32 NodeA, int32 NodeB, double Conductance);
+
+	/** Builds the off-diagonal rows from the edges added since Reset */
+	void Finalize();
+
+	/** Out = A * X, rows split across workers when there are at least MinRowsForParallel */
+	void Multiply(TConstArrayView<double> X, TArrayView<double> Out, int32 MinRowsForParallel) const;
+
+private:
+
+	struct FEdge
+	{
+		int32 A;
+		int32 B;
+		double Conductance;
+	};
+	TArray<FEdge> Edges;
+};
+
+namespace HeatNetwork
+{
+	struct FSolveResult
+	{
+		int32 Iterations = 0;
+
+		/** |b - A * T| / |b| at exit */
+		double RelativeResidual = 0.0;
+		bool bConverged = false;
+	};
+
+	/**
+	 *  Jacobi-preconditioned conjugate gradient. InOutX holds the initial guess (the previous temperatures,
+	 *  which are already close) and receives the solution.
+	 */
+	FSolveResult SolveConjugateGradient(const FHeatNetworkSystem& System, TArray<double>& InOutX, double Tolerance, int32 MaxIterations, int32 MinRowsForParallel);
+}
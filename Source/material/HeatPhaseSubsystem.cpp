@@ -0,0 +1,140 @@
+// HeatPhaseSubsystem.cpp
+
+#include "HeatPhaseSubsystem.h"
+
+#include "Engine/World.h"
+#include "ActorPoolSubsystem.h"
+#include "HeatSimSettings.h"
+#include "Puddle.h"
+#include "VapourEffect.h"
+#include "MaterialSimStats.h"
+
+bool UHeatPhaseSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UHeatPhaseSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	const UHeatSimSettings* Settings = GetDefault<UHeatSimSettings>();
+	PuddleClass = Settings->PuddleClass.LoadSynchronous();
+	VapourClass = Settings->VapourClass.LoadSynchronous();
+
+	// spawned up front, so the first melts do not hitch
+	if (UActorPoolSubsystem* Pool = InWorld.GetSubsystem<UActorPoolSubsystem>())
+	{
+		Pool->Prewarm(PuddleClass, Settings->PuddlePoolSize);
+		Pool->Prewarm(VapourClass, Settings->VapourPoolSize);
+	}
+}
+
+void UHeatPhaseSubsystem::Deinitialize()
+{
+	ActivePuddles.Empty();
+	PendingWater.Empty();
+
+	Super::Deinitialize();
+}
+
+float UHeatPhaseSubsystem::IceToWaterVolumeM3(float IceVolumeM3, float IceDensityKgM3)
+{
+	return IceVolumeM3 * IceDensityKgM3 / GetDefault<UHeatSimSettings>()->WaterDensityKgM3;
+}
+
+void UHeatPhaseSubsystem::DepositMeltWater(const AActor* Source, const FVector& Location, float WaterVolumeM3)
+{
+	if (!PuddleClass || WaterVolumeM3 <= 0.0f) return;
+
+	MATERIALSIM_SCOPE(Phase_DepositMeltWater);
+
+	const UHeatSimSettings* Settings = GetDefault<UHeatSimSettings>();
+
+	FVector Ground = Location;
+	FHitResult Hit;
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(PuddleGround), false, Source);
+	if (GetWorld()->LineTraceSingleByChannel(Hit, Location, Location - FVector(0.0f, 0.0f, Settings->PuddleGroundTraceCm), ECC_Visibility, Params))
+	{
+		Ground = Hit.ImpactPoint;
+	}
+
+	PendingWater.Add({ Ground, WaterVolumeM3 });
+}
+
+void UHeatPhaseSubsystem::FlushMeltWater()
+{
+	if (PendingWater.IsEmpty()) return;
+
+	MATERIALSIM_SCOPE(Phase_FlushMeltWater);
+
+	UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+
+	// deposits made from here on, e.g. by a puddle's own callbacks, wait for the next flush
+	const TArray<FPendingWater> Batch = MoveTemp(PendingWater);
+	PendingWater.Reset();
+
+	for (const FPendingWater& Water : Batch)
+	{
+		if (APuddle* Puddle = FindPuddleNear(Water.Ground))
+		{
+			Puddle->AddWater(Water.VolumeM3);
+			continue;
+		}
+
+		APuddle* Puddle = Pool ? Pool->AcquireAs<APuddle>(PuddleClass, FTransform(Water.Ground)) : nullptr;
+		if (!Puddle) continue;
+
+		Puddle->AddWater(Water.VolumeM3);
+		ActivePuddles.Add(Puddle);
+	}
+}
+
+APuddle* UHeatPhaseSubsystem::FindPuddleNear(const FVector& Location)
+{
+	const float MergeRadiusSq = FMath::Square(GetDefault<UHeatSimSettings>()->PuddleMergeRadiusCm);
+
+	APuddle* Nearest = nullptr;
+	double NearestDistSq = MergeRadiusSq;
+
+	for (int32 i = ActivePuddles.Num() - 1; i >= 0; --i)
+	{
+		APuddle* Puddle = ActivePuddles[i].Get();
+		if (!Puddle || Puddle->GetWaterVolumeM3() <= 0.0f)
+		{
+			ActivePuddles.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		const double DistSq = FVector::DistSquared(Puddle->GetActorLocation(), Location);
+		if (DistSq <= NearestDistSq)
+		{
+			Nearest = Puddle;
+			NearestDistSq = DistSq;
+		}
+	}
+	return Nearest;
+}
+
+void UHeatPhaseSubsystem::ClearWater()
+{
+	for (const TWeakObjectPtr<APuddle>& Puddle : ActivePuddles)
+	{
+		UActorPoolSubsystem::ReleaseOrDestroy(Puddle.Get());
+	}
+	ActivePuddles.Reset();
+	PendingWater.Reset();
+}
+
+AVapourEffect* UHeatPhaseSubsystem::AcquireVapour(APuddle* Puddle)
+{
+	if (!VapourClass || !Puddle) return nullptr;
+
+	UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+	AVapourEffect* Vapour = Pool ? Pool->AcquireAs<AVapourEffect>(VapourClass, Puddle->GetActorTransform()) : nullptr;
+	if (Vapour)
+	{
+		Vapour->SetOwner(Puddle);
+	}
+	return Vapour;
+}
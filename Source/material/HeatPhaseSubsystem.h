@@ -0,0 +1,66 @@
+// HeatPhaseSubsystem.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HeatPhaseSubsystem.generated.h"
+
+class APuddle;
+class AVapourEffect;
+
+/**
+ *  Ice -> water -> steam. Melting receivers hand their melt water to DepositMeltWater, which merges it into a
+ *  nearby puddle or places a pooled one on the ground below; hot puddles then evaporate into pooled vapour effects.
+ *  Puddle and vapour classes and pool sizes come from UHeatSimSettings.
+ */
+UCLASS()
+class MATERIAL_API UHeatPhaseSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	/** Water volume of melted ice */
+	static float IceToWaterVolumeM3(float IceVolumeM3, float IceDensityKgM3);
+
+	/**
+	 *  Puts melt water on the ground below Location. Source is ignored by the ground trace. The water is queued and
+	 *  placed by FlushMeltWater, since deposits come in while the heat sim applies its batch
+	 */
+	void DepositMeltWater(const AActor* Source, const FVector& Location, float WaterVolumeM3);
+
+	/** Merges or places the queued melt water. Called by the heat sim once its receivers are applied */
+	void FlushMeltWater();
+
+	/** Returns every puddle to the pool, e.g. when a checkpoint puts the ice back */
+	void ClearWater();
+
+	/** A pooled vapour effect owned by the puddle, or null when no vapour class is set */
+	AVapourEffect* AcquireVapour(APuddle* Puddle);
+
+private:
+
+	/** Nearest live puddle within the merge radius. Also drops puddles that went back to the pool */
+	APuddle* FindPuddleNear(const FVector& Location);
+
+	UPROPERTY(Transient)
+	TSubclassOf<APuddle> PuddleClass;
+
+	UPROPERTY(Transient)
+	TSubclassOf<AVapourEffect> VapourClass;
+
+	/** Puddles handed out so far. Ones gone back to the pool are dropped on the next deposit */
+	TArray<TWeakObjectPtr<APuddle>> ActivePuddles;
+
+	struct FPendingWater
+	{
+		FVector Ground;
+		float VolumeM3;
+	};
+	TArray<FPendingWater> PendingWater;
+};
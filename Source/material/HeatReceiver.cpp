@@ -0,0 +1,16 @@
+// HeatReceiver.cpp
+
+#include "HeatReceiver.h"
+
+void IHeatReceiver::StartHeating_Implementation(ATemperature* FireRef)
+{
+}
+
+void IHeatReceiver::StopHeating_Implementation(ATemperature* FireRef)
+{
+}
+
+bool IHeatReceiver::IsHeating_Implementation() const
+{
+	return false;
+}
@@ -0,0 +1,86 @@
+// HeatReceiver.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "HeatReceiver.generated.h"
+
+class ATemperature;
+
+/** Thermal body of a receiver, pulled by UHeatSimSubsystem whenever the receiver's mesh, form or settings change */
+struct FHeatReceiverBody
+{
+	float VolumeM3 = 1.0f;
+	float EffectiveAreaM2 = 1.0f;
+	float TotalMeltEnergyJ = 1.0f;
+	float SimTimeScale = 3600.0f;
+	bool bCanMelt = true;
+};
+
+/**
+ *  HeatReceiver interface
+ */
+UINTERFACE(MinimalAPI, Blueprintable)
+class UHeatReceiver : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ *  Anything that can be heated by an ATemperature source.
+ *  Native receivers also provide a thermal body so UHeatSimSubsystem can integrate their melt in its batch;
+ *  Blueprint receivers only get the start/stop events.
+ */
+class IHeatReceiver
+{
+	GENERATED_BODY()
+
+public:
+
+	/** A heat source has started heating this receiver. Called once per source, fluxes add up */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category="Heat")
+	void StartHeating(ATemperature* FireRef);
+
+	/** The heat source stopped heating this receiver. Other sources in range keep heating it */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category="Heat")
+	void StopHeating(ATemperature* FireRef);
+
+	/** Returns true while at least one heat source is heating this receiver */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category="Heat")
+	bool IsHeating() const;
+
+	/** Fills in the thermal body for the batched melt. Returning false makes this an event-only receiver */
+	virtual bool GetHeatReceiverBody(FHeatReceiverBody& OutBody, float& OutEnergyAccumJ) const { return false; }
+
+	/** Receives the integrated melt state from UHeatSimSubsystem */
+	virtual void ApplyHeatSimState(float NewEnergyJ, float NewMeltAlpha, float ReceivedPowerW, float DistCm, float DeltaTime) {}
+
+	/**
+	 *  Analytic melt: no ApplyHeatSimState calls follow until the timeline ends.
+	 *  The visuals should run from StartAlpha at StartTime to fully melted at EndTime, in world time seconds.
+	 *  It is called again with a new window at every key of the predicted curve, before the previous one ran out.
+	 */
+	virtual void BeginMeltTimeline(float StartAlpha, float StartTime, float EndTime) {}
+
+	/** The analytic prediction was invalidated, per-step ApplyHeatSimState calls resume */
+	virtual void EndMeltTimeline() {}
+};
+
+/**
+ *  Native-only receiver for actors that own many thermal bodies (e.g. instanced ice).
+ *  Each body is registered with UHeatSimSubsystem::RegisterReceiverInstance under a key chosen by the owner,
+ *  and gets no start/stop events, only the batched melt state.
+ */
+class IHeatInstancedReceiver
+{
+public:
+
+	virtual ~IHeatInstancedReceiver() = default;
+
+	/** Same as IHeatReceiver::ApplyHeatSimState for the body registered under InstanceKey */
+	virtual void ApplyInstanceHeatSimState(int32 InstanceKey, float NewEnergyJ, float NewMeltAlpha, float ReceivedPowerW, float DistCm, float DeltaTime) = 0;
+
+	virtual void BeginInstanceMeltTimeline(int32 InstanceKey, float StartAlpha, float StartTime, float EndTime) {}
+	virtual void EndInstanceMeltTimeline(int32 InstanceKey) {}
+};
@@ -0,0 +1,9 @@
+// HeatSimSettings.cpp
+
+#include "HeatSimSettings.h"
+
+UHeatSimSettings::UHeatSimSettings()
+{
+	CategoryName = TEXT("Game");
+	SectionName = TEXT("Heat Simulation");
+}
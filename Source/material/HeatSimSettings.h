@@ -0,0 +1,165 @@
+// HeatSimSettings.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "Engine/EngineTypes.h"
+#include "HeatSimSettings.generated.h"
+
+class UTextureRenderTarget2D;
+class UMaterialParameterCollection;
+class APuddle;
+class AVapourEffect;
+
+/**
+ *  Project-wide settings for UHeatSimSubsystem, found under Project Settings > Game > Heat Simulation.
+ */
+UCLASS(config=Game, defaultconfig, meta=(DisplayName="Heat Simulation"))
+class MATERIAL_API UHeatSimSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	UHeatSimSettings();
+
+	/** Length of one thermal sim step. Every step integrates exactly this much time, whatever the frame rate */
+	UPROPERTY(config, EditAnywhere, Category="Timestep", meta=(ClampMin=0.001, ClampMax=0.5, Units="s"))
+	float FixedTimeStep = 1.0f / 30.0f;
+
+	/** Most sim steps run in one frame. Time beyond that is dropped, so a hitch slows the sim down instead of melting blocks in one go */
+	UPROPERTY(config, EditAnywhere, Category="Timestep", meta=(ClampMin=1, ClampMax=32))
+	int32 MaxStepsPerFrame = 4;
+
+	/**
+	 *  Receivers whose setup is static (no movement, no pair change, no temperature change) get their melt completion
+	 *  solved in closed form and scheduled as a single timer instead of being integrated every step.
+	 */
+	UPROPERTY(config, EditAnywhere, Category="Melt")
+	bool bAnalyticMelt = false;
+
+	/**
+	 *  Points on the analytic melt curve the material timeline is re-anchored at. The curve is not linear while sources
+	 *  cool down, so the material's linear ramp is aimed at the next key and re-issued when it is reached.
+	 */
+	UPROPERTY(config, EditAnywhere, Category="Melt", meta=(ClampMin=1, ClampMax=16, EditCondition="bAnalyticMelt"))
+	int32 AnalyticTimelineKeys = 4;
+
+	/**
+	 *  Advances receivers as an implicit thermal network instead of integrating each one explicitly: receivers are nodes
+	 *  joined by radiation edges to sources, contact edges to nearby receivers and convection edges to the ambient air and
+	 *  room voxels, and every NetworkTimeStep the backward-Euler step is solved with conjugate gradient on worker threads.
+	 *  Stable for any step length, so its cost follows the edge count rather than the frame rate. Analytic melt is not used.
+	 */
+	UPROPERTY(config, EditAnywhere, Category="Network")
+	bool bThermalNetwork = false;
+
+	/** Simulated time between network solves, before each receiver's SimTimeScale */
+	UPROPERTY(config, EditAnywhere, Category="Network", meta=(ClampMin=0.01, ClampMax=5, Units="s", EditCondition="bThermalNetwork"))
+	float NetworkTimeStep = 0.1f;
+
+	/** A receiver's latent heat is spread over this many degrees above 0 C, so it melts as it warms through them */
+	UPROPERTY(config, EditAnywhere, Category="Network", meta=(ClampMin=0.01, EditCondition="bThermalNetwork"))
+	float MeltRangeK = 1.0f;
+
+	/** Receivers closer than this exchange heat with each other */
+	UPROPERTY(config, EditAnywhere, Category="Network", meta=(ClampMin=0, Units="cm", EditCondition="bThermalNetwork"))
+	float ContactDistanceCm = 120.0f;
+
+	/** Heat transfer coefficient between touching receivers over the smaller of the two areas, in W/(m^2 K) */
+	UPROPERTY(config, EditAnywhere, Category="Network", meta=(ClampMin=0, EditCondition="bThermalNetwork"))
+	float ContactTransferCoefficient = 50.0f;
+
+	/** Convection between every receiver and the air, in W/(m^2 K). 0 leaves receivers heated by sources and rooms only */
+	UPROPERTY(config, EditAnywhere, Category="Network", meta=(ClampMin=0, EditCondition="bThermalNetwork"))
+	float AmbientTransferCoefficient = 0.0f;
+
+	UPROPERTY(config, EditAnywhere, Category="Network", meta=(EditCondition="bThermalNetwork"))
+	float AmbientTemperature = 20.0f;
+
+	/** The solve stops once the residual has dropped by this factor */
+	UPROPERTY(config, EditAnywhere, Category="Network", meta=(ClampMin=1e-12, ClampMax=0.1, EditCondition="bThermalNetwork"))
+	float SolverTolerance = 1e-6f;
+
+	UPROPERTY(config, EditAnywhere, Category="Network", meta=(ClampMin=1, EditCondition="bThermalNetwork"))
+	int32 SolverMaxIterations = 100;
+
+	/** Networks with fewer nodes than this are solved on the game thread */
+	UPROPERTY(config, EditAnywhere, Category="Network", meta=(ClampMin=0, EditCondition="bThermalNetwork"))
+	int32 MinNodesForParallel = 1024;
+
+	/** Scales every source/receiver pair by a line-of-sight trace, so walls block radiant heat. Changes which blocks melt, so opt-in */
+	UPROPERTY(config, EditAnywhere, Category="Occlusion")
+	bool bOcclusion = false;
+
+	UPROPERTY(config, EditAnywhere, Category="Occlusion", meta=(EditCondition="bOcclusion"))
+	TEnumAsByte<ECollisionChannel> OcclusionChannel = ECC_Visibility;
+
+	/** Async traces started per frame. New pairs beyond that are traced on later frames */
+	UPROPERTY(config, EditAnywhere, Category="Occlusion", meta=(ClampMin=1, EditCondition="bOcclusion"))
+	int32 MaxOcclusionTracesPerFrame = 64;
+
+	/** A pair is traced again once its source or receiver has moved further than this since the last trace */
+	UPROPERTY(config, EditAnywhere, Category="Occlusion", meta=(ClampMin=0, Units="cm", EditCondition="bOcclusion"))
+	float OcclusionMoveThreshold = 25.0f;
+
+	/** Fraction of the power that still reaches a receiver behind geometry */
+	UPROPERTY(config, EditAnywhere, Category="Occlusion", meta=(ClampMin=0, ClampMax=1, EditCondition="bOcclusion"))
+	float OccludedTransmission = 0.0f;
+
+	/**
+	 *  Top-down temperature grid written by UThermalTextureSubsystem, in degrees C, for thermal vision to sample.
+	 *  Its size sets the grid resolution; the format is switched to R16F when play begins.
+	 */
+	UPROPERTY(config, EditAnywhere, Category="Thermal Texture")
+	TSoftObjectPtr<UTextureRenderTarget2D> ThermalRenderTarget;
+
+	/** Receives the grid placement: ThermalTextureOrigin = (min X, min Y, 1 / width, 1 / height) in world units */
+	UPROPERTY(config, EditAnywhere, Category="Thermal Texture")
+	TSoftObjectPtr<UMaterialParameterCollection> ThermalParameterCollection;
+
+	UPROPERTY(config, EditAnywhere, Category="Thermal Texture")
+	FName ThermalOriginParamName = TEXT("ThermalTextureOrigin");
+
+	UPROPERTY(config, EditAnywhere, Category="Thermal Texture", meta=(ClampMin=10, Units="cm"))
+	float ThermalCellSizeCm = 50.0f;
+
+	/** Seconds between grid updates, 0 updates every frame */
+	UPROPERTY(config, EditAnywhere, Category="Thermal Texture", meta=(ClampMin=0, Units="s"))
+	float ThermalUpdateInterval = 0.1f;
+
+	/** Value of cells nothing warm or cold is in */
+	UPROPERTY(config, EditAnywhere, Category="Thermal Texture")
+	float ThermalAmbientTemperature = 20.0f;
+
+	/** Heat sources are splatted with a linear falloff over this radius */
+	UPROPERTY(config, EditAnywhere, Category="Thermal Texture", meta=(ClampMin=0, Units="cm"))
+	float ThermalSourceRadiusCm = 150.0f;
+
+	/** Spawned, through the actor pool, where melt water lands. Nothing is left behind when unset */
+	UPROPERTY(config, EditAnywhere, Category="Phase")
+	TSoftClassPtr<APuddle> PuddleClass;
+
+	/** Steam over evaporating puddles */
+	UPROPERTY(config, EditAnywhere, Category="Phase")
+	TSoftClassPtr<AVapourEffect> VapourClass;
+
+	/** Puddles spawned into the pool when play begins */
+	UPROPERTY(config, EditAnywhere, Category="Phase", meta=(ClampMin=0))
+	int32 PuddlePoolSize = 16;
+
+	UPROPERTY(config, EditAnywhere, Category="Phase", meta=(ClampMin=0))
+	int32 VapourPoolSize = 8;
+
+	/** Melt water landing this close to a puddle is added to it instead of starting a new one */
+	UPROPERTY(config, EditAnywhere, Category="Phase", meta=(ClampMin=0, Units="cm"))
+	float PuddleMergeRadiusCm = 100.0f;
+
+	/** How far below a melting block the ground is searched for */
+	UPROPERTY(config, EditAnywhere, Category="Phase", meta=(ClampMin=0, Units="cm"))
+	float PuddleGroundTraceCm = 500.0f;
+
+	UPROPERTY(config, EditAnywhere, Category="Phase", meta=(ClampMin=1))
+	float WaterDensityKgM3 = 1000.0f;
+};
@@ -0,0 +1,1662 @@
+// HeatSimSubsystem.cpp
+
+#include "HeatSimSubsystem.h"
+
+#include "Temperature.h"
+#include "HeatSimSettings.h"
+#include "TickLODSubsystem.h"
+#include "ThermalRoomVolume.h"
+#include "HeatPhaseSubsystem.h"
+#include "EngineUtils.h"
+#include "TimerManager.h"
+#include "HeatMassProcessors.h"
+#include "MassEntitySubsystem.h"
+#include "MassEntityManager.h"
+#include "MassExecutor.h"
+#include "MaterialSimStats.h"
+#include "HeatTelemetry.h"
+#include "HeatNetworkSolver.h"
+#include "material.h"
+
+int32 FHeatSlotMap::Add()
+{
+	int32 Id;
+	if (FreeIds.Num() > 0)
+	{
+		Id = FreeIds.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Id = IdToIndex.Add(INDEX_NONE);
+	}
+
+	IdToIndex[Id] = IndexToId.Add(Id);
+	return Id;
+}
+
+int32 FHeatSlotMap::RemoveAtSwap(int32 Id, int32& OutIndex)
+{
+	OutIndex = GetIndex(Id);
+	if (OutIndex == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 LastIndex = IndexToId.Num() - 1;
+	const int32 MovedId = IndexToId[LastIndex];
+
+	IndexToId.RemoveAtSwap(OutIndex, EAllowShrinking::No);
+	IdToIndex[Id] = INDEX_NONE;
+	FreeIds.Add(Id);
+
+	if (MovedId != Id)
+	{
+		IdToIndex[MovedId] = OutIndex;
+		return MovedId;
+	}
+	return INDEX_NONE;
+}
+
+bool UHeatSimSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UHeatSimSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	for (TActorIterator<AActor> It(&InWorld); It; ++It)
+	{
+		if (It->Implements<UHeatReceiver>())
+		{
+			RegisterReceiver(*It);
+		}
+	}
+
+	ActorSpawnedHandle = InWorld.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UHeatSimSubsystem::OnActorSpawned));
+	OcclusionTraceDelegate.BindUObject(this, &UHeatSimSubsystem::OnOcclusionTraceDone);
+}
+
+void UHeatSimSubsystem::OnActorSpawned(AActor* Actor)
+{
+	if (Actor && Actor->Implements<UHeatReceiver>())
+	{
+		RegisterReceiver(Actor);
+	}
+}
+
+void UHeatSimSubsystem::OnReceiverEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterReceiver(Actor);
+}
+
+void UHeatSimSubsystem::Deinitialize()
+{
+	if (ActorSpawnedHandle.IsValid())
+	{
+		GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+		ActorSpawnedHandle.Reset();
+	}
+	GetWorld()->GetTimerManager().ClearAllTimersForObject(this);
+
+	SourceSlots = FHeatSlotMap();
+	SourceActors.Empty();
+	SourceLocations.Empty();
+	SourceMaxDistances.Empty();
+	SourcePowerW.Empty();
+	SourceAwake.Empty();
+	SourcePairs.Empty();
+	SourceMoveHandles.Empty();
+	SourceUpdateIntervals.Empty();
+	SourceAccumTimes.Empty();
+	SourceVisualsDirty.Empty();
+
+	ReceiverSlots = FHeatSlotMap();
+	ReceiverActors.Empty();
+	ReceiverInterfaces.Empty();
+	ReceiverInstanceOwners.Empty();
+	ReceiverInstanceKeys.Empty();
+	ReceiverLocations.Empty();
+	ReceiverCells.Empty();
+	ReceiverAreaM2.Empty();
+	ReceiverTotalEnergyJ.Empty();
+	ReceiverTimeScale.Empty();
+	ReceiverEnergyJ.Empty();
+	ReceiverAlpha.Empty();
+	ReceiverContributions.Empty();
+	ReceiverCanMelt.Empty();
+	ReceiverApplyIntervals.Empty();
+	ReceiverApplyAccumTimes.Empty();
+	ReceiverAnalyticStates.Empty();
+	ReceiverAnalyticStartTimes.Empty();
+	ReceiverAnalyticStartEnergyJ.Empty();
+	ReceiverAnalyticKeys.Empty();
+	ReceiverAnalyticTerms.Empty();
+	ReceiverMeltTimers.Empty();
+	ReceiverMoveHandles.Empty();
+	ReceiverIdsByActor.Empty();
+
+	Rooms.Empty();
+
+	PendingApply.Empty();
+	PendingApplyIndices.Empty();
+	PendingMassApplyIndices.Empty();
+
+	OcclusionTraces.Empty();
+	OcclusionCursor = 0;
+	OcclusionTraceDelegate.Unbind();
+
+	MassRadiantProcessor = nullptr;
+	MassMeltProcessor = nullptr;
+	MassReceiverArchetype = FMassArchetypeHandle();
+	MassSources.Reset();
+	NumMassReceivers = 0;
+	StepAccumulator = 0.0;
+	SimTime = 0.0;
+
+	ReceiverHash.Reset(ReceiverHash.GetCellSize());
+	DirtySourceIds.Empty();
+	DirtyReceiverIds.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UHeatSimSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHeatSimSubsystem, STATGROUP_Tickables);
+}
+
+int32 UHeatSimSubsystem::RegisterSource(ATemperature* Source)
+{
+	if (!Source) return INDEX_NONE;
+
+	const int32 Id = SourceSlots.Add();
+	SourceActors.Add(Source);
+	SourceLocations.Add(Source->GetActorLocation());
+	SourceMaxDistances.Add(Source->MaxHeatDistance);
+	SourcePowerW.Add(Source->GetTotalRadiantPowerW());
+	SourceAwake.Add(1);
+	SourcePairs.AddDefaulted();
+
+	FDelegateHandle MoveHandle;
+	if (USceneComponent* Root = Source->GetRootComponent())
+	{
+		MoveHandle = Root->TransformUpdated.AddUObject(this, &UHeatSimSubsystem::OnSourceMoved, Id);
+	}
+	SourceMoveHandles.Add(MoveHandle);
+	SourceUpdateIntervals.Add(0.0f);
+	SourceAccumTimes.Add(0.0f);
+
+	if (UTickLODSubsystem* TickLOD = GetWorld()->GetSubsystem<UTickLODSubsystem>())
+	{
+		TickLOD->RegisterActor(Source, FOnTickLODChanged::CreateUObject(this, &UHeatSimSubsystem::OnSourceLODChanged, Id));
+	}
+	SourceVisualsDirty.Add(0);
+
+	DirtySourceIds.Add(Id);
+	return Id;
+}
+
+void UHeatSimSubsystem::UnregisterSource(int32 SourceId)
+{
+	const int32 Index = SourceSlots.GetIndex(SourceId);
+	if (Index == INDEX_NONE) return;
+
+	ATemperature* Source = SourceActors[Index].Get();
+	if (Source && Source->GetRootComponent())
+	{
+		Source->GetRootComponent()->TransformUpdated.Remove(SourceMoveHandles[Index]);
+	}
+	if (UTickLODSubsystem* TickLOD = GetWorld()->GetSubsystem<UTickLODSubsystem>())
+	{
+		TickLOD->UnregisterActor(Source);
+	}
+
+	InvalidateSourceReceivers(Index);
+	CancelOcclusionTraces(INDEX_NONE, SourceId);
+	const TSet<int32> Paired = MoveTemp(SourcePairs[Index]);
+
+	int32 RemovedIndex;
+	SourceSlots.RemoveAtSwap(SourceId, RemovedIndex);
+	RemoveSourceAt(RemovedIndex);
+	DirtySourceIds.Remove(SourceId);
+
+	for (const int32 ReceiverId : Paired)
+	{
+		const int32 ReceiverIndex = ReceiverSlots.GetIndex(ReceiverId);
+		if (ReceiverIndex == INDEX_NONE) continue;
+
+		ReceiverContributions[ReceiverIndex].RemoveAllSwap([SourceId](const FHeatContribution& C) { return C.SourceId == SourceId; });
+		PendingPairEvents.Add({ ReceiverId, Source, false });
+	}
+	DispatchPairEvents();
+}
+
+void UHeatSimSubsystem::RemoveSourceAt(int32 Index)
+{
+	SourceActors.RemoveAtSwap(Index, EAllowShrinking::No);
+	SourceLocations.RemoveAtSwap(Index, EAllowShrinking::No);
+	SourceMaxDistances.RemoveAtSwap(Index, EAllowShrinking::No);
+	SourcePowerW.RemoveAtSwap(Index, EAllowShrinking::No);
+	SourceAwake.RemoveAtSwap(Index, EAllowShrinking::No);
+	SourcePairs.RemoveAtSwap(Index, EAllowShrinking::No);
+	SourceMoveHandles.RemoveAtSwap(Index, EAllowShrinking::No);
+	SourceUpdateIntervals.RemoveAtSwap(Index, EAllowShrinking::No);
+	SourceAccumTimes.RemoveAtSwap(Index, EAllowShrinking::No);
+	SourceVisualsDirty.RemoveAtSwap(Index, EAllowShrinking::No);
+}
+
+void UHeatSimSubsystem::MarkSourceDirty(int32 SourceId)
+{
+	if (SourceSlots.GetIndex(SourceId) != INDEX_NONE)
+	{
+		DirtySourceIds.Add(SourceId);
+	}
+}
+
+void UHeatSimSubsystem::WakeSource(int32 SourceId)
+{
+	const int32 Index = SourceSlots.GetIndex(SourceId);
+	if (Index == INDEX_NONE) return;
+
+	SourceAwake[Index] = 1;
+	DirtySourceIds.Add(SourceId);
+	InvalidateSourceReceivers(Index);
+}
+
+void UHeatSimSubsystem::RegisterReceiver(AActor* Receiver, bool bAuthoritativeEnergy)
+{
+	if (!Receiver || !Receiver->Implements<UHeatReceiver>()) return;
+
+	IHeatReceiver* Interface = Cast<IHeatReceiver>(Receiver);
+
+	FHeatReceiverBody Body;
+	float EnergyAccumJ = 0.0f;
+	if (!Interface || !Interface->GetHeatReceiverBody(Body, EnergyAccumJ))
+	{
+		Body.bCanMelt = false;
+	}
+
+	const float TotalEnergyJ = FMath::Max(Body.TotalMeltEnergyJ, 1.0f);
+
+	if (const int32* ExistingId = ReceiverIdsByActor.Find(Receiver))
+	{
+		const int32 Index = ReceiverSlots.GetIndex(*ExistingId);
+
+		if (bAuthoritativeEnergy)
+		{
+			// the prediction is dropped, not read back, and a queued apply would write the old state over the new one
+			if (ReceiverAnalyticStates[Index] == EHeatAnalyticState::Active)
+			{
+				GetWorld()->GetTimerManager().ClearTimer(ReceiverMeltTimers[Index]);
+				EndReceiverTimeline(Index);
+			}
+			if (const int32* PendingIndex = PendingApplyIndices.Find(*ExistingId))
+			{
+				PendingApply[*PendingIndex].Actor.Reset();
+				PendingApplyIndices.Remove(*ExistingId);
+			}
+		}
+		// the actor's own energy is stale while a timeline runs, the baked prediction is the real state
+		else if (ReceiverAnalyticStates[Index] == EHeatAnalyticState::Active)
+		{
+			InvalidateAnalyticMelt(Index);
+			EnergyAccumJ = ReceiverEnergyJ[Index];
+		}
+		ReceiverAnalyticStates[Index] = EHeatAnalyticState::Pending;
+
+		ReceiverAreaM2[Index] = Body.EffectiveAreaM2;
+		ReceiverTotalEnergyJ[Index] = TotalEnergyJ;
+		ReceiverTimeScale[Index] = FMath::Max(Body.SimTimeScale, 0.0f);
+		ReceiverEnergyJ[Index] = EnergyAccumJ;
+		ReceiverAlpha[Index] = FMath::Clamp(EnergyAccumJ / TotalEnergyJ, 0.0f, 1.0f);
+
+		ReceiverCanMelt[Index] = Body.bCanMelt ? 1 : 0;
+		return;
+	}
+
+	const int32 Id = AddReceiverSlot(Receiver, Interface, Receiver->GetActorLocation(), Body, EnergyAccumJ);
+	const int32 Index = ReceiverSlots.GetIndex(Id);
+
+	if (USceneComponent* Root = Receiver->GetRootComponent())
+	{
+		ReceiverMoveHandles[Index] = Root->TransformUpdated.AddUObject(this, &UHeatSimSubsystem::OnReceiverMoved, Id);
+	}
+	ReceiverIdsByActor.Add(Receiver, Id);
+	Receiver->OnEndPlay.AddUniqueDynamic(this, &UHeatSimSubsystem::OnReceiverEndPlay);
+
+	if (UTickLODSubsystem* TickLOD = GetWorld()->GetSubsystem<UTickLODSubsystem>())
+	{
+		TickLOD->RegisterActor(Receiver, FOnTickLODChanged::CreateUObject(this, &UHeatSimSubsystem::OnReceiverLODChanged, Id));
+	}
+}
+
+int32 UHeatSimSubsystem::RegisterReceiverInstance(AActor* Owner, IHeatInstancedReceiver* Callbacks, int32 InstanceKey, const FVector& Location, const FHeatReceiverBody& Body, float EnergyAccumJ)
+{
+	if (!Owner || !Callbacks) return INDEX_NONE;
+
+	const int32 Id = AddReceiverSlot(Owner, nullptr, Location, Body, EnergyAccumJ);
+	const int32 Index = ReceiverSlots.GetIndex(Id);
+	ReceiverInstanceOwners[Index] = Callbacks;
+	ReceiverInstanceKeys[Index] = InstanceKey;
+	return Id;
+}
+
+int32 UHeatSimSubsystem::AddReceiverSlot(AActor* Owner, IHeatReceiver* Interface, const FVector& Location, const FHeatReceiverBody& Body, float EnergyAccumJ)
+{
+	const float TotalEnergyJ = FMath::Max(Body.TotalMeltEnergyJ, 1.0f);
+
+	const int32 Id = ReceiverSlots.Add();
+	const FIntVector Cell = ReceiverHash.GetCell(Location);
+
+	ReceiverActors.Add(Owner);
+	ReceiverInterfaces.Add(Interface);
+	ReceiverInstanceOwners.Add(nullptr);
+	ReceiverInstanceKeys.Add(INDEX_NONE);
+	ReceiverLocations.Add(Location);
+	ReceiverCells.Add(Cell);
+	ReceiverAreaM2.Add(Body.EffectiveAreaM2);
+	ReceiverTotalEnergyJ.Add(TotalEnergyJ);
+	ReceiverTimeScale.Add(FMath::Max(Body.SimTimeScale, 0.0f));
+	ReceiverEnergyJ.Add(EnergyAccumJ);
+	ReceiverAlpha.Add(FMath::Clamp(EnergyAccumJ / TotalEnergyJ, 0.0f, 1.0f));
+	ReceiverContributions.AddDefaulted();
+	ReceiverCanMelt.Add(Body.bCanMelt ? 1 : 0);
+	ReceiverMoveHandles.AddDefaulted();
+	ReceiverApplyIntervals.Add(0.0f);
+	ReceiverApplyAccumTimes.Add(0.0f);
+	ReceiverAnalyticStates.Add(EHeatAnalyticState::Pending);
+	ReceiverAnalyticStartTimes.Add(0.0);
+	ReceiverAnalyticStartEnergyJ.Add(0.0f);
+	ReceiverAnalyticKeys.Add(0);
+	ReceiverAnalyticTerms.AddDefaulted();
+	ReceiverMeltTimers.AddDefaulted();
+
+	ReceiverHash.Insert(Id, Cell);
+	DirtyReceiverIds.Add(Id);
+	return Id;
+}
+
+void UHeatSimSubsystem::UnregisterReceiver(AActor* Receiver)
+{
+	int32 ReceiverId;
+	if (!Receiver || !ReceiverIdsByActor.RemoveAndCopyValue(Receiver, ReceiverId)) return;
+
+	const int32 Index = ReceiverSlots.GetIndex(ReceiverId);
+
+	if (USceneComponent* Root = Receiver->GetRootComponent())
+	{
+		Root->TransformUpdated.Remove(ReceiverMoveHandles[Index]);
+	}
+	Receiver->OnEndPlay.RemoveDynamic(this, &UHeatSimSubsystem::OnReceiverEndPlay);
+
+	if (UTickLODSubsystem* TickLOD = GetWorld()->GetSubsystem<UTickLODSubsystem>())
+	{
+		TickLOD->UnregisterActor(Receiver);
+	}
+
+	RemoveReceiverById(ReceiverId);
+}
+
+void UHeatSimSubsystem::UnregisterReceiverInstance(int32 ReceiverId)
+{
+	const int32 Index = ReceiverSlots.GetIndex(ReceiverId);
+	if (Index == INDEX_NONE || !ReceiverInstanceOwners[Index]) return;
+
+	RemoveReceiverById(ReceiverId);
+}
+
+void UHeatSimSubsystem::RemoveReceiverById(int32 ReceiverId)
+{
+	const int32 Index = ReceiverSlots.GetIndex(ReceiverId);
+
+	ReceiverHash.Remove(ReceiverId, ReceiverCells[Index]);
+	for (TSet<int32>& Pairs : SourcePairs)
+	{
+		Pairs.Remove(ReceiverId);
+	}
+	DirtyReceiverIds.Remove(ReceiverId);
+	CancelOcclusionTraces(ReceiverId, INDEX_NONE);
+	GetWorld()->GetTimerManager().ClearTimer(ReceiverMeltTimers[Index]);
+
+	// the id may be reused before the pending states are applied
+	if (const int32* PendingIndex = PendingApplyIndices.Find(ReceiverId))
+	{
+		PendingApply[*PendingIndex].Actor.Reset();
+		PendingApplyIndices.Remove(ReceiverId);
+	}
+
+	int32 RemovedIndex;
+	ReceiverSlots.RemoveAtSwap(ReceiverId, RemovedIndex);
+	RemoveReceiverAt(RemovedIndex);
+}
+
+void UHeatSimSubsystem::RemoveReceiverAt(int32 Index)
+{
+	ReceiverActors.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverInterfaces.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverInstanceOwners.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverInstanceKeys.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverLocations.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverCells.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverAreaM2.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverTotalEnergyJ.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverTimeScale.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverEnergyJ.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverAlpha.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverContributions.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverCanMelt.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverApplyIntervals.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverApplyAccumTimes.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverAnalyticStates.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverAnalyticStartTimes.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverAnalyticStartEnergyJ.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverAnalyticKeys.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverAnalyticTerms.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverMeltTimers.RemoveAtSwap(Index, EAllowShrinking::No);
+	ReceiverMoveHandles.RemoveAtSwap(Index, EAllowShrinking::No);
+}
+
+void UHeatSimSubsystem::AddReceiverSource(const AActor* Receiver, ATemperature* Source)
+{
+	const int32* ReceiverId = ReceiverIdsByActor.Find(Receiver);
+	const int32 SourceIndex = Source ? SourceSlots.GetIndex(Source->GetHeatSourceId()) : INDEX_NONE;
+	if (!ReceiverId || SourceIndex == INDEX_NONE) return;
+
+	AddPair(ReceiverSlots.GetIndex(*ReceiverId), SourceIndex);
+}
+
+void UHeatSimSubsystem::RemoveReceiverSource(const AActor* Receiver, ATemperature* Source)
+{
+	const int32* ReceiverId = ReceiverIdsByActor.Find(Receiver);
+	const int32 SourceIndex = Source ? SourceSlots.GetIndex(Source->GetHeatSourceId()) : INDEX_NONE;
+	if (!ReceiverId || SourceIndex == INDEX_NONE) return;
+
+	RemovePair(ReceiverSlots.GetIndex(*ReceiverId), SourceIndex);
+}
+
+void UHeatSimSubsystem::AddPair(int32 ReceiverIndex, int32 SourceIndex)
+{
+	const int32 ReceiverId = ReceiverSlots.IndexToId[ReceiverIndex];
+	const int32 SourceId = SourceSlots.IndexToId[SourceIndex];
+
+	SourcePairs[SourceIndex].Add(ReceiverId);
+
+	FHeatContributionList& Contributions = ReceiverContributions[ReceiverIndex];
+	if (!Contributions.ContainsByPredicate([SourceId](const FHeatContribution& C) { return C.SourceId == SourceId; }))
+	{
+		InvalidateAnalyticMelt(ReceiverIndex);
+		Contributions.Add({ SourceId, 0.0f });
+	}
+}
+
+void UHeatSimSubsystem::RemovePair(int32 ReceiverIndex, int32 SourceIndex)
+{
+	const int32 ReceiverId = ReceiverSlots.IndexToId[ReceiverIndex];
+	const int32 SourceId = SourceSlots.IndexToId[SourceIndex];
+
+	SourcePairs[SourceIndex].Remove(ReceiverId);
+	InvalidateAnalyticMelt(ReceiverIndex);
+	ReceiverContributions[ReceiverIndex].RemoveAllSwap([SourceId](const FHeatContribution& C) { return C.SourceId == SourceId; });
+}
+
+TArray<TScriptInterface<IHeatReceiver>> UHeatSimSubsystem::GetReceiversInRange(const ATemperature* Source) const
+{
+	TArray<TScriptInterface<IHeatReceiver>> Result;
+
+	const int32 SourceIndex = Source ? SourceSlots.GetIndex(Source->GetHeatSourceId()) : INDEX_NONE;
+	if (SourceIndex == INDEX_NONE) return Result;
+
+	Result.Reserve(SourcePairs[SourceIndex].Num());
+	for (const int32 ReceiverId : SourcePairs[SourceIndex])
+	{
+		const int32 ReceiverIndex = ReceiverSlots.GetIndex(ReceiverId);
+		AActor* Receiver = ReceiverActors[ReceiverIndex].Get();
+		// instanced bodies are owned by an actor that is not a receiver itself, Blueprint-only receivers have no native interface
+		if (Receiver && Receiver->Implements<UHeatReceiver>())
+		{
+			Result.Add(TScriptInterface<IHeatReceiver>(Receiver));
+		}
+	}
+	return Result;
+}
+
+void UHeatSimSubsystem::GatherThermalPoints(TArray<FHeatThermalPoint>& OutPoints) const
+{
+	OutPoints.Reserve(OutPoints.Num() + SourceActors.Num() + ReceiverActors.Num());
+
+	for (int32 i = 0; i < SourceActors.Num(); ++i)
+	{
+		if (const ATemperature* Source = SourceActors[i].Get())
+		{
+			OutPoints.Add({ SourceLocations[i], Source->Temperature, true });
+		}
+	}
+
+	for (int32 i = 0; i < ReceiverActors.Num(); ++i)
+	{
+		if (ReceiverCanMelt[i] && ReceiverAlpha[i] < 1.0f)
+		{
+			OutPoints.Add({ ReceiverLocations[i], 0.0f, false });
+		}
+	}
+}
+
+void UHeatSimSubsystem::OnSourceMoved(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport, int32 SourceId)
+{
+	const int32 Index = SourceSlots.GetIndex(SourceId);
+	if (Index == INDEX_NONE || !Component) return;
+
+	// scale and rotation changes broadcast too, only a new location matters here
+	const FVector Location = Component->GetComponentLocation();
+	if (Location.Equals(SourceLocations[Index], 0.01)) return;
+
+	SourceLocations[Index] = Location;
+	DirtySourceIds.Add(SourceId);
+	InvalidateSourceReceivers(Index);
+}
+
+void UHeatSimSubsystem::OnReceiverMoved(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport, int32 ReceiverId)
+{
+	const int32 Index = ReceiverSlots.GetIndex(ReceiverId);
+	if (Index == INDEX_NONE || !Component) return;
+
+	SetReceiverLocation(ReceiverId, Component->GetComponentLocation());
+}
+
+void UHeatSimSubsystem::MoveReceiverInstance(int32 ReceiverId, const FVector& NewLocation)
+{
+	if (ReceiverSlots.GetIndex(ReceiverId) == INDEX_NONE) return;
+
+	SetReceiverLocation(ReceiverId, NewLocation);
+}
+
+void UHeatSimSubsystem::SetReceiverLocation(int32 ReceiverId, const FVector& Location)
+{
+	const int32 Index = ReceiverSlots.GetIndex(ReceiverId);
+	if (Location.Equals(ReceiverLocations[Index], 0.01)) return;
+
+	ReceiverLocations[Index] = Location;
+	InvalidateAnalyticMelt(Index);
+
+	const FIntVector NewCell = ReceiverHash.GetCell(Location);
+	if (ReceiverHash.Move(ReceiverId, ReceiverCells[Index], NewCell))
+	{
+		ReceiverCells[Index] = NewCell;
+	}
+
+	DirtyReceiverIds.Add(ReceiverId);
+}
+
+FMassEntityManager* UHeatSimSubsystem::GetMassEntityManager() const
+{
+	UMassEntitySubsystem* MassSubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>();
+	return MassSubsystem ? &MassSubsystem->GetMutableEntityManager() : nullptr;
+}
+
+FMassEntityHandle UHeatSimSubsystem::CreateMassReceiver(AActor* Owner, IHeatInstancedReceiver* Callbacks, int32 InstanceKey, const FVector& Location, const FHeatReceiverBody& Body, float EnergyAccumJ)
+{
+	FMassEntityManager* EntityManager = GetMassEntityManager();
+	if (!Owner || !Callbacks || !EntityManager) return FMassEntityHandle();
+
+	if (!MassRadiantProcessor)
+	{
+		MassRadiantProcessor = NewObject<UHeatMassRadiantProcessor>(this);
+		MassRadiantProcessor->CallInitialize(this, EntityManager->AsShared());
+		MassMeltProcessor = NewObject<UHeatMassMeltProcessor>(this);
+		MassMeltProcessor->CallInitialize(this, EntityManager->AsShared());
+
+		MassReceiverArchetype = EntityManager->CreateArchetype({
+			FHeatMassLocationFragment::StaticStruct(),
+			FHeatMassBodyFragment::StaticStruct(),
+			FHeatMassStateFragment::StaticStruct(),
+			FHeatMassOwnerFragment::StaticStruct() });
+	}
+
+	const FMassEntityHandle Entity = EntityManager->CreateEntity(MassReceiverArchetype);
+	const float TotalEnergyJ = FMath::Max(Body.TotalMeltEnergyJ, 1.0f);
+
+	EntityManager->GetFragmentDataChecked<FHeatMassLocationFragment>(Entity).Location = Location;
+
+	FHeatMassBodyFragment& BodyFragment = EntityManager->GetFragmentDataChecked<FHeatMassBodyFragment>(Entity);
+	BodyFragment.EffectiveAreaM2 = Body.EffectiveAreaM2;
+	BodyFragment.TotalMeltEnergyJ = TotalEnergyJ;
+	BodyFragment.VolumeM3 = Body.VolumeM3;
+	BodyFragment.SimTimeScale = FMath::Max(Body.SimTimeScale, 0.0f);
+
+	FHeatMassStateFragment& State = EntityManager->GetFragmentDataChecked<FHeatMassStateFragment>(Entity);
+	State.EnergyJ = EnergyAccumJ;
+	State.MeltAlpha = FMath::Clamp(EnergyAccumJ / TotalEnergyJ, 0.0f, 1.0f);
+
+	FHeatMassOwnerFragment& OwnerFragment = EntityManager->GetFragmentDataChecked<FHeatMassOwnerFragment>(Entity);
+	OwnerFragment.Owner = Owner;
+	OwnerFragment.Callbacks = Callbacks;
+	OwnerFragment.InstanceKey = InstanceKey;
+	OwnerFragment.OwnerClass = Owner->GetClass();
+
+	if (!Body.bCanMelt || State.MeltAlpha >= 1.0f)
+	{
+		EntityManager->AddTagToEntity(Entity, FHeatMassMeltedTag::StaticStruct());
+	}
+
+	++NumMassReceivers;
+	return Entity;
+}
+
+void UHeatSimSubsystem::DestroyMassReceiver(FMassEntityHandle Entity)
+{
+	FMassEntityManager* EntityManager = GetMassEntityManager();
+	if (!EntityManager || !EntityManager->IsEntityValid(Entity)) return;
+
+	// the handle may be reused before the pending states are applied
+	int32 PendingIndex;
+	if (PendingMassApplyIndices.RemoveAndCopyValue(Entity, PendingIndex))
+	{
+		PendingApply[PendingIndex].Actor.Reset();
+	}
+
+	EntityManager->DestroyEntity(Entity);
+	--NumMassReceivers;
+}
+
+void UHeatSimSubsystem::MoveMassReceiver(FMassEntityHandle Entity, const FVector& NewLocation)
+{
+	FMassEntityManager* EntityManager = GetMassEntityManager();
+	if (!EntityManager || !EntityManager->IsEntityValid(Entity)) return;
+
+	EntityManager->GetFragmentDataChecked<FHeatMassLocationFragment>(Entity).Location = NewLocation;
+}
+
+float UHeatSimSubsystem::GetMassReceiverEnergyJ(FMassEntityHandle Entity) const
+{
+	FMassEntityManager* EntityManager = GetMassEntityManager();
+	if (!EntityManager || !EntityManager->IsEntityValid(Entity)) return 0.0f;
+
+	return EntityManager->GetFragmentDataChecked<FHeatMassStateFragment>(Entity).EnergyJ;
+}
+
+void UHeatSimSubsystem::OnSourceLODChanged(float Interval, int32 SourceId)
+{
+	const int32 Index = SourceSlots.GetIndex(SourceId);
+	if (Index != INDEX_NONE)
+	{
+		SourceUpdateIntervals[Index] = Interval;
+	}
+}
+
+void UHeatSimSubsystem::OnReceiverLODChanged(float Interval, int32 ReceiverId)
+{
+	const int32 Index = ReceiverSlots.GetIndex(ReceiverId);
+	if (Index != INDEX_NONE)
+	{
+		ReceiverApplyIntervals[Index] = Interval;
+	}
+}
+
+void UHeatSimSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	MATERIALSIM_SCOPE(HeatSim_Tick);
+
+	const UHeatSimSettings* Settings = GetDefault<UHeatSimSettings>();
+	const double Step = FMath::Max(Settings->FixedTimeStep, 0.001f);
+
+	StepAccumulator += DeltaTime;
+
+	int32 NumSteps = FMath::FloorToInt32(StepAccumulator / Step);
+	StepAccumulator -= NumSteps * Step;
+
+	// past the cap the backlog is dropped, the sim runs slower than real time rather than taking bigger steps
+	if (NumSteps > Settings->MaxStepsPerFrame)
+	{
+		NumSteps = Settings->MaxStepsPerFrame;
+	}
+
+	for (int32 StepIndex = 0; StepIndex < NumSteps; ++StepIndex)
+	{
+		StepSimulation(static_cast<float>(Step));
+	}
+
+	UpdateSourceVisuals();
+	ApplyPendingReceivers();
+	UpdateOcclusion();
+
+#if STATS
+	int32 NumPairs = 0;
+	for (const FHeatContributionList& Contributions : ReceiverContributions)
+	{
+		NumPairs += Contributions.Num();
+	}
+	SET_DWORD_STAT(STAT_MaterialSim_Sources, SourceSlots.Num());
+	SET_DWORD_STAT(STAT_MaterialSim_Receivers, ReceiverSlots.Num());
+	SET_DWORD_STAT(STAT_MaterialSim_MassReceivers, NumMassReceivers);
+	SET_DWORD_STAT(STAT_MaterialSim_Pairs, NumPairs);
+#endif
+
+#if !UE_BUILD_SHIPPING
+	FHeatTelemetry::Get().DrawSummary();
+#endif
+}
+
+void UHeatSimSubsystem::StepSimulation(float StepTime)
+{
+	MATERIALSIM_SCOPE(HeatSim_Step);
+
+	SimTime += StepTime;
+
+	UpdateSources(StepTime);
+	UpdateRooms(StepTime);
+	UpdatePairs();
+	DispatchPairEvents();
+
+	const UHeatSimSettings* Settings = GetDefault<UHeatSimSettings>();
+	if (Settings->bThermalNetwork)
+	{
+		// implicit, so it stays stable at its own much longer step
+		NetworkAccumulator += StepTime;
+		if (NetworkAccumulator >= Settings->NetworkTimeStep)
+		{
+			UpdateReceiverNetwork(NetworkAccumulator);
+			NetworkAccumulator = 0.0f;
+		}
+	}
+	else
+	{
+		UpdateReceivers(StepTime);
+	}
+
+	UpdateMassReceivers(StepTime);
+}
+
+void UHeatSimSubsystem::UpdateSources(float DeltaTime)
+{
+	MATERIALSIM_SCOPE(HeatSim_UpdateSources);
+
+	for (int32 i = 0; i < SourceActors.Num(); ++i)
+	{
+		// dormant sources keep their last power and pairs, only a wake or a move touches them again
+		if (!SourceAwake[i]) continue;
+
+		ATemperature* Source = SourceActors[i].Get();
+		if (!Source)
+		{
+			SourcePowerW[i] = 0.0f;
+			SourceAwake[i] = 0;
+			continue;
+		}
+
+		// far sources advance less often, with all the time skipped since their last update. Cooling is linear, so
+		// receivers still get the power the source has at this step rather than the one from its last update
+		SourceAccumTimes[i] += DeltaTime;
+		if (SourceAccumTimes[i] < SourceUpdateIntervals[i])
+		{
+			SourcePowerW[i] = Source->GetRadiantPowerAfterW(SourceAccumTimes[i]);
+			continue;
+		}
+
+		Source->AdvanceHeat(SourceAccumTimes[i]);
+		SourceAccumTimes[i] = 0.0f;
+		SourceVisualsDirty[i] = 1;
+
+		if (SourceMaxDistances[i] != Source->MaxHeatDistance)
+		{
+			SourceMaxDistances[i] = Source->MaxHeatDistance;
+			DirtySourceIds.Add(SourceSlots.IndexToId[i]);
+			InvalidateSourceReceivers(i);
+		}
+		SourcePowerW[i] = Source->GetTotalRadiantPowerW();
+
+		if (Source->IsHeatSteady())
+		{
+			SourceAwake[i] = 0;
+		}
+	}
+}
+
+void UHeatSimSubsystem::UpdateSourceVisuals()
+{
+	for (int32 i = 0; i < SourceActors.Num(); ++i)
+	{
+		if (!SourceVisualsDirty[i]) continue;
+
+		SourceVisualsDirty[i] = 0;
+		if (ATemperature* Source = SourceActors[i].Get())
+		{
+			Source->UpdateHeatVisuals();
+		}
+	}
+}
+
+void UHeatSimSubsystem::RegisterRoom(AThermalRoomVolume* Room)
+{
+	if (Room)
+	{
+		Rooms.AddUnique(Room);
+	}
+}
+
+void UHeatSimSubsystem::UnregisterRoom(AThermalRoomVolume* Room)
+{
+	Rooms.Remove(Room);
+}
+
+void UHeatSimSubsystem::UpdateRooms(float DeltaTime)
+{
+	MATERIALSIM_SCOPE(HeatSim_UpdateRooms);
+
+	for (const TWeakObjectPtr<AThermalRoomVolume>& RoomPtr : Rooms)
+	{
+		AThermalRoomVolume* Room = RoomPtr.Get();
+		if (!Room) continue;
+
+		for (int32 i = 0; i < SourceActors.Num(); ++i)
+		{
+			if (const ATemperature* Source = SourceActors[i].Get())
+			{
+				Room->InjectSource(SourceLocations[i], Source->Temperature);
+			}
+		}
+
+		Room->StepConduction(DeltaTime);
+	}
+}
+
+const AThermalRoomVolume* UHeatSimSubsystem::FindRoom(const FVector& Location, float& OutExcessTemperature) const
+{
+	for (const TWeakObjectPtr<AThermalRoomVolume>& RoomPtr : Rooms)
+	{
+		const AThermalRoomVolume* Room = RoomPtr.Get();
+		if (Room && Room->SampleExcessTemperature(Location, OutExcessTemperature))
+		{
+			return Room;
+		}
+	}
+	return nullptr;
+}
+
+void UHeatSimSubsystem::RebuildSpatialHash(float NewCellSize)
+{
+	ReceiverHash.Reset(NewCellSize);
+
+	for (int32 i = 0; i < ReceiverLocations.Num(); ++i)
+	{
+		ReceiverCells[i] = ReceiverHash.GetCell(ReceiverLocations[i]);
+		ReceiverHash.Insert(ReceiverSlots.IndexToId[i], ReceiverCells[i]);
+	}
+}
+
+bool UHeatSimSubsystem::IsPairInRange(int32 SourceIndex, int32 ReceiverIndex) const
+{
+	const float MaxDist = SourceMaxDistances[SourceIndex];
+	if (MaxDist <= 0.0f) return false;
+
+	if (FVector::DistSquared(SourceLocations[SourceIndex], ReceiverLocations[ReceiverIndex]) > FMath::Square(MaxDist))
+	{
+		return false;
+	}
+
+	const ATemperature* Source = SourceActors[SourceIndex].Get();
+	const AActor* Receiver = ReceiverActors[ReceiverIndex].Get();
+	if (!Source || !Receiver || Receiver == Source) return false;
+
+	return !Source->IceClassFilter || Receiver->IsA(Source->IceClassFilter);
+}
+
+void UHeatSimSubsystem::UpdatePairs()
+{
+	MATERIALSIM_SCOPE(HeatSim_UpdatePairs);
+
+	if (DirtySourceIds.Num() == 0 && DirtyReceiverIds.Num() == 0) return;
+
+	// keep the cells at least as large as the biggest heat radius so a query stays within a few cells
+	float MaxRadius = 100.0f;
+	for (const float Radius : SourceMaxDistances)
+	{
+		MaxRadius = FMath::Max(MaxRadius, Radius);
+	}
+
+	const float CellSize = ReceiverHash.GetCellSize();
+	if (MaxRadius > CellSize || MaxRadius < CellSize * 0.5f)
+	{
+		RebuildSpatialHash(MaxRadius);
+	}
+
+	TArray<int32> Candidates;
+	TSet<int32> InRange;
+
+	for (const int32 SourceId : DirtySourceIds)
+	{
+		const int32 SourceIndex = SourceSlots.GetIndex(SourceId);
+		if (SourceIndex == INDEX_NONE) continue;
+
+		Candidates.Reset();
+		InRange.Reset();
+
+		if (SourceMaxDistances[SourceIndex] > 0.0f)
+		{
+			ReceiverHash.Query(SourceLocations[SourceIndex], SourceMaxDistances[SourceIndex], Candidates);
+		}
+
+		for (const int32 ReceiverId : Candidates)
+		{
+			const int32 ReceiverIndex = ReceiverSlots.GetIndex(ReceiverId);
+			if (ReceiverIndex != INDEX_NONE && IsPairInRange(SourceIndex, ReceiverIndex))
+			{
+				InRange.Add(ReceiverId);
+			}
+		}
+
+		ATemperature* Source = SourceActors[SourceIndex].Get();
+		const TSet<int32> OldPairs = SourcePairs[SourceIndex];
+		for (const int32 ReceiverId : OldPairs)
+		{
+			if (!InRange.Contains(ReceiverId))
+			{
+				RemovePair(ReceiverSlots.GetIndex(ReceiverId), SourceIndex);
+				PendingPairEvents.Add({ ReceiverId, Source, false });
+			}
+		}
+		for (const int32 ReceiverId : InRange)
+		{
+			if (!OldPairs.Contains(ReceiverId))
+			{
+				AddPair(ReceiverSlots.GetIndex(ReceiverId), SourceIndex);
+				PendingPairEvents.Add({ ReceiverId, Source, true });
+			}
+		}
+	}
+
+	// sources are few, so a moved receiver is simply tested against every source that was not re-queried above
+	for (const int32 ReceiverId : DirtyReceiverIds)
+	{
+		const int32 ReceiverIndex = ReceiverSlots.GetIndex(ReceiverId);
+		if (ReceiverIndex == INDEX_NONE) continue;
+
+		for (int32 SourceIndex = 0; SourceIndex < SourcePairs.Num(); ++SourceIndex)
+		{
+			const int32 SourceId = SourceSlots.IndexToId[SourceIndex];
+			if (DirtySourceIds.Contains(SourceId)) continue;
+
+			const bool bInRange = IsPairInRange(SourceIndex, ReceiverIndex);
+			const bool bPaired = SourcePairs[SourceIndex].Contains(ReceiverId);
+			if (bInRange == bPaired) continue;
+
+			if (bInRange)
+			{
+				AddPair(ReceiverIndex, SourceIndex);
+			}
+			else
+			{
+				RemovePair(ReceiverIndex, SourceIndex);
+			}
+			PendingPairEvents.Add({ ReceiverId, SourceActors[SourceIndex], bInRange });
+		}
+	}
+
+	DirtySourceIds.Reset();
+	DirtyReceiverIds.Reset();
+}
+
+void UHeatSimSubsystem::DispatchPairEvents()
+{
+	if (PendingPairEvents.Num() == 0) return;
+
+	MATERIALSIM_SCOPE(HeatSim_DispatchPairEvents);
+
+	TArray<FPairEvent> Events = MoveTemp(PendingPairEvents);
+	PendingPairEvents.Reset();
+
+	for (const FPairEvent& Event : Events)
+	{
+		const int32 ReceiverIndex = ReceiverSlots.GetIndex(Event.ReceiverId);
+		if (ReceiverIndex == INDEX_NONE) continue;
+
+		AActor* Receiver = ReceiverActors[ReceiverIndex].Get();
+		ATemperature* Source = Event.Source.Get();
+		if (!Receiver || !Source || ReceiverInstanceOwners[ReceiverIndex]) continue;
+
+		if (Event.bEnter)
+		{
+			IHeatReceiver::Execute_StartHeating(Receiver, Source);
+		}
+		else
+		{
+			IHeatReceiver::Execute_StopHeating(Receiver, Source);
+		}
+	}
+}
+
+void UHeatSimSubsystem::GatherReceivedPower()
+{
+	PairBatch.Reset();
+	PairReceiverIndices.Reset();
+
+	// gather every live pair into flat arrays so the flux kernel runs over them in one pass
+	const int32 NumReceivers = ReceiverActors.Num();
+	for (int32 i = 0; i < NumReceivers; ++i)
+	{
+		if (!ReceiverCanMelt[i] || ReceiverAlpha[i] >= 1.0f || ReceiverAnalyticStates[i] == EHeatAnalyticState::Active) continue;
+
+		for (FHeatContribution& Contribution : ReceiverContributions[i])
+		{
+			Contribution.PowerW = 0.0f;
+
+			const int32 SourceIndex = SourceSlots.GetIndex(Contribution.SourceId);
+			if (SourceIndex == INDEX_NONE) continue;
+
+			PairBatch.Add(SourceLocations[SourceIndex], ReceiverLocations[i], SourcePowerW[SourceIndex], SourceMaxDistances[SourceIndex], ReceiverAreaM2[i]);
+			PairReceiverIndices.Add(i);
+		}
+	}
+
+	ReceiverPowerW.Reset();
+	ReceiverPowerW.SetNumZeroed(NumReceivers);
+	ReceiverNearestDistCm.Init(TNumericLimits<float>::Max(), NumReceivers);
+
+	const int32 NumPairs = PairBatch.Num();
+	if (NumPairs > 0)
+	{
+		PairPowerW.SetNumUninitialized(NumPairs, EAllowShrinking::No);
+		PairDistCm.SetNumUninitialized(NumPairs, EAllowShrinking::No);
+		HeatFlux::ComputeReceivedPower(PairBatch, PairPowerW, PairDistCm);
+	}
+
+	// pairs were gathered receiver by receiver, so each receiver owns a contiguous run
+	int32 Pair = 0;
+	while (Pair < NumPairs)
+	{
+		const int32 i = PairReceiverIndices[Pair];
+
+		for (FHeatContribution& Contribution : ReceiverContributions[i])
+		{
+			if (SourceSlots.GetIndex(Contribution.SourceId) == INDEX_NONE) continue;
+
+			Contribution.PowerW = PairPowerW[Pair] * Contribution.Visibility;
+			if (Contribution.PowerW > 0.0f)
+			{
+				ReceiverPowerW[i] += Contribution.PowerW;
+				ReceiverNearestDistCm[i] = FMath::Min(ReceiverNearestDistCm[i], PairDistCm[Pair]);
+			}
+			++Pair;
+		}
+	}
+}
+
+void UHeatSimSubsystem::UpdateReceivers(float DeltaTime)
+{
+	MATERIALSIM_SCOPE(HeatSim_UpdateReceivers);
+
+	GatherReceivedPower();
+
+	const int32 NumReceivers = ReceiverActors.Num();
+
+	// conduction from the room grid: only heat above the room's ambient reaches the receivers, and it arrives on the
+	// grid's clock, so it is rescaled to the receiver's own time scale before being summed with the radiant power
+	if (Rooms.Num() > 0)
+	{
+		for (int32 i = 0; i < NumReceivers; ++i)
+		{
+			if (!ReceiverCanMelt[i] || ReceiverAlpha[i] >= 1.0f || ReceiverAnalyticStates[i] == EHeatAnalyticState::Active || ReceiverTimeScale[i] <= 0.0f) continue;
+
+			float ExcessTemperature;
+			if (const AThermalRoomVolume* Room = FindRoom(ReceiverLocations[i], ExcessTemperature))
+			{
+				const float RoomPowerW = Room->HeatTransferCoefficient * ReceiverAreaM2[i] * ExcessTemperature;
+				ReceiverPowerW[i] += RoomPowerW * Room->SimTimeScale / ReceiverTimeScale[i];
+			}
+		}
+	}
+
+	for (int32 i = 0; i < NumReceivers; ++i)
+	{
+		const float TotalPowerW = ReceiverPowerW[i];
+		if (TotalPowerW <= 0.0f) continue;
+
+		ReceiverEnergyJ[i] += TotalPowerW * DeltaTime * ReceiverTimeScale[i];
+		ReceiverAlpha[i] = FMath::Clamp(ReceiverEnergyJ[i] / ReceiverTotalEnergyJ[i], 0.0f, 1.0f);
+
+		// the melt itself is integrated every step, far receivers only get their visuals pushed less often
+		ReceiverApplyAccumTimes[i] += DeltaTime;
+		if (ReceiverApplyAccumTimes[i] < ReceiverApplyIntervals[i] && ReceiverAlpha[i] < 1.0f) continue;
+
+		const float ApplyTime = ReceiverApplyAccumTimes[i];
+		ReceiverApplyAccumTimes[i] = 0.0f;
+
+		const float NearestDistCm = ReceiverNearestDistCm[i] < TNumericLimits<float>::Max() ? ReceiverNearestDistCm[i] : 0.0f;
+
+		QueueApply(i, TotalPowerW, NearestDistCm, ApplyTime);
+	}
+
+	if (GetDefault<UHeatSimSettings>()->bAnalyticMelt)
+	{
+		for (int32 i = 0; i < NumReceivers; ++i)
+		{
+			if (ReceiverAnalyticStates[i] == EHeatAnalyticState::Pending)
+			{
+				TryBeginAnalyticMelt(i);
+			}
+		}
+	}
+}
+
+void UHeatSimSubsystem::UpdateReceiverNetwork(float DeltaTime)
+{
+	MATERIALSIM_SCOPE(HeatSim_UpdateNetwork);
+
+	const UHeatSimSettings* Settings = GetDefault<UHeatSimSettings>();
+
+	GatherReceivedPower();
+
+	// every receiver still melting is a free node, anything else it exchanges heat with is held at its own temperature
+	const int32 NumReceivers = ReceiverActors.Num();
+	NetworkNodeOfReceiver.Init(INDEX_NONE, NumReceivers);
+	NetworkReceivers.Reset();
+	for (int32 i = 0; i < NumReceivers; ++i)
+	{
+		if (!ReceiverCanMelt[i] || ReceiverAlpha[i] >= 1.0f || ReceiverAnalyticStates[i] == EHeatAnalyticState::Active || ReceiverTimeScale[i] <= 0.0f) continue;
+
+		NetworkNodeOfReceiver[i] = NetworkReceivers.Add(i);
+	}
+
+	const int32 NumNodes = NetworkReceivers.Num();
+	if (NumNodes == 0) return;
+
+	const double MeltRangeK = FMath::Max(Settings->MeltRangeK, 0.01f);
+	const float ContactDistCm = Settings->ContactDistanceCm;
+	const bool bContact = Settings->ContactTransferCoefficient > 0.0f && ContactDistCm > 0.0f;
+
+	NetworkSystem.Reset(NumNodes);
+	NetworkTemperatures.SetNumUninitialized(NumNodes, EAllowShrinking::No);
+
+	for (int32 Node = 0; Node < NumNodes; ++Node)
+	{
+		const int32 i = NetworkReceivers[Node];
+
+		// the latent heat becomes an apparent capacity over the melt range, the receiver's time scale stretches its step
+		const double CapacityJK = ReceiverTotalEnergyJ[i] / MeltRangeK;
+		const double Previous = MeltRangeK * ReceiverEnergyJ[i] / ReceiverTotalEnergyJ[i];
+		NetworkSystem.AddCapacity(Node, CapacityJK / (static_cast<double>(DeltaTime) * ReceiverTimeScale[i]), Previous);
+		NetworkTemperatures[Node] = Previous;
+
+		// radiation, linearised so a receiver at the melting point takes exactly the explicit power
+		for (const FHeatContribution& Contribution : ReceiverContributions[i])
+		{
+			const int32 SourceIndex = SourceSlots.GetIndex(Contribution.SourceId);
+			const ATemperature* Source = SourceIndex != INDEX_NONE ? SourceActors[SourceIndex].Get() : nullptr;
+			if (!Source || Contribution.PowerW <= 0.0f || Source->Temperature <= 0.0f) continue;
+
+			NetworkSystem.AddFixedEdge(Node, Contribution.PowerW / Source->Temperature, Source->Temperature);
+		}
+
+		if (Settings->AmbientTransferCoefficient > 0.0f)
+		{
+			NetworkSystem.AddFixedEdge(Node, Settings->AmbientTransferCoefficient * ReceiverAreaM2[i], Settings->AmbientTemperature);
+		}
+
+		// node temperatures are measured from the melting point, so the voxel is held at its excess over ambient like in
+		// UpdateReceivers, and the room's time scale is carried over to the receiver's step
+		float ExcessTemperature;
+		if (const AThermalRoomVolume* Room = FindRoom(ReceiverLocations[i], ExcessTemperature))
+		{
+			if (ExcessTemperature > 0.0f)
+			{
+				const double Conductance = Room->HeatTransferCoefficient * ReceiverAreaM2[i] * Room->SimTimeScale / ReceiverTimeScale[i];
+				NetworkSystem.AddFixedEdge(Node, Conductance, ExcessTemperature);
+			}
+		}
+
+		if (!bContact) continue;
+
+		// each touching pair is added once, from its lower node
+		NetworkCandidates.Reset();
+		ReceiverHash.Query(ReceiverLocations[i], ContactDistCm, NetworkCandidates);
+		for (const int32 OtherId : NetworkCandidates)
+		{
+			const int32 j = ReceiverSlots.GetIndex(OtherId);
+			const int32 OtherNode = j != INDEX_NONE ? NetworkNodeOfReceiver[j] : INDEX_NONE;
+			if (OtherNode <= Node) continue;
+			if (FVector::DistSquared(ReceiverLocations[i], ReceiverLocations[j]) > FMath::Square(ContactDistCm)) continue;
+
+			NetworkSystem.AddEdge(Node, OtherNode, Settings->ContactTransferCoefficient * FMath::Min(ReceiverAreaM2[i], ReceiverAreaM2[j]));
+		}
+	}
+
+	NetworkSystem.Finalize();
+
+	// the previous temperatures are the initial guess, a few iterations are enough when little changed
+	const HeatNetwork::FSolveResult Result = HeatNetwork::SolveConjugateGradient(NetworkSystem, NetworkTemperatures,
+		Settings->SolverTolerance, Settings->SolverMaxIterations, Settings->MinNodesForParallel);
+
+	if (!Result.bConverged)
+	{
+		UE_LOG(Logmaterial, Verbose, TEXT("heat network: %d nodes not converged after %d iterations, residual %g"), NumNodes, Result.Iterations, Result.RelativeResidual);
+	}
+
+	SET_DWORD_STAT(STAT_MaterialSim_NetworkEdges, NetworkSystem.NumEdges());
+	SET_DWORD_STAT(STAT_MaterialSim_NetworkIterations, Result.Iterations);
+
+	for (int32 Node = 0; Node < NumNodes; ++Node)
+	{
+		const int32 i = NetworkReceivers[Node];
+
+		const float TotalEnergyJ = ReceiverTotalEnergyJ[i];
+		const float NewEnergyJ = FMath::Clamp(static_cast<float>(NetworkTemperatures[Node] / MeltRangeK) * TotalEnergyJ, 0.0f, TotalEnergyJ);
+		if (NewEnergyJ == ReceiverEnergyJ[i]) continue;
+
+		const float NetPowerW = (NewEnergyJ - ReceiverEnergyJ[i]) / (DeltaTime * ReceiverTimeScale[i]);
+		ReceiverEnergyJ[i] = NewEnergyJ;
+		ReceiverAlpha[i] = FMath::Clamp(NewEnergyJ / TotalEnergyJ, 0.0f, 1.0f);
+
+		ReceiverApplyAccumTimes[i] += DeltaTime;
+		if (ReceiverApplyAccumTimes[i] < ReceiverApplyIntervals[i] && ReceiverAlpha[i] < 1.0f) continue;
+
+		const float ApplyTime = ReceiverApplyAccumTimes[i];
+		ReceiverApplyAccumTimes[i] = 0.0f;
+
+		const float NearestDistCm = ReceiverNearestDistCm[i] < TNumericLimits<float>::Max() ? ReceiverNearestDistCm[i] : 0.0f;
+
+		QueueApply(i, NetPowerW, NearestDistCm, ApplyTime);
+	}
+}
+
+void UHeatSimSubsystem::QueueApply(int32 Index, float PowerW, float DistCm, float DeltaTime)
+{
+	// several steps can run in one frame, the actor only sees the latest state and the summed step time
+	const int32 ReceiverId = ReceiverSlots.IndexToId[Index];
+	if (const int32* PendingIndex = PendingApplyIndices.Find(ReceiverId))
+	{
+		FPendingApply& Apply = PendingApply[*PendingIndex];
+		Apply.EnergyJ = ReceiverEnergyJ[Index];
+		Apply.Alpha = ReceiverAlpha[Index];
+		Apply.ReceivedPowerW = PowerW;
+		Apply.DistCm = DistCm;
+		Apply.DeltaTime += DeltaTime;
+	}
+	else
+	{
+		PendingApplyIndices.Add(ReceiverId, PendingApply.Add({ ReceiverActors[Index], ReceiverInterfaces[Index], ReceiverInstanceOwners[Index], ReceiverInstanceKeys[Index], ReceiverEnergyJ[Index], ReceiverAlpha[Index], PowerW, DistCm, DeltaTime }));
+	}
+}
+
+bool UHeatSimSubsystem::IsInsideRoom(const FVector& Location) const
+{
+	for (const TWeakObjectPtr<AThermalRoomVolume>& RoomPtr : Rooms)
+	{
+		float VoxelTemperature;
+		if (RoomPtr.IsValid() && RoomPtr->SampleTemperature(Location, VoxelTemperature))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void UHeatSimSubsystem::TryBeginAnalyticMelt(int32 Index)
+{
+	if (!ReceiverCanMelt[Index] || ReceiverAlpha[Index] >= 1.0f || ReceiverContributions[Index].Num() == 0) return;
+
+	// conduction depends on the whole grid, so receivers inside a room keep stepping
+	if (IsInsideRoom(ReceiverLocations[Index]))
+	{
+		ReceiverAnalyticStates[Index] = EHeatAnalyticState::Ineligible;
+		return;
+	}
+
+	// a pair still waiting for its line-of-sight trace would be predicted with the wrong power
+	const bool bOcclusion = GetDefault<UHeatSimSettings>()->bOcclusion;
+	if (bOcclusion && ReceiverContributions[Index].ContainsByPredicate([](const FHeatContribution& C) { return C.TraceState != EHeatTraceState::Done; }))
+	{
+		return;
+	}
+
+	FHeatAnalyticTermList& Terms = ReceiverAnalyticTerms[Index];
+	Terms.Reset();
+
+	for (const FHeatContribution& Contribution : ReceiverContributions[Index])
+	{
+		const int32 SourceIndex = SourceSlots.GetIndex(Contribution.SourceId);
+		const ATemperature* Source = SourceIndex != INDEX_NONE ? SourceActors[SourceIndex].Get() : nullptr;
+		if (!Source) continue;
+
+		const float DistCm = FVector::Dist(SourceLocations[SourceIndex], ReceiverLocations[Index]);
+
+		FHeatAnalyticTerm& Term = Terms.AddDefaulted_GetRef();
+		Term.Coupling = HeatFlux::ReceivedPowerW(DistCm, 1.0f, SourceMaxDistances[SourceIndex], ReceiverAreaM2[Index]) * Contribution.Visibility;
+		Term.RadiantCoeff = Source->Emissivity * Source->StefanBoltzmannSigma * Source->SurfaceAreaM2;
+		Term.StartTemperatureC = Source->Temperature;
+		Term.CoolRate = FMath::Max(Source->CoolRate, 0.0f);
+	}
+
+	const double TimeScale = ReceiverTimeScale[Index];
+	const double RequiredJ = ReceiverTotalEnergyJ[Index] - ReceiverEnergyJ[Index];
+	const double MeltSeconds = TimeScale > 0.0 ? HeatFlux::SolveAnalyticTime(Terms, RequiredJ / TimeScale) : -1.0;
+
+	if (MeltSeconds <= 0.0)
+	{
+		ReceiverAnalyticStates[Index] = EHeatAnalyticState::Ineligible;
+		return;
+	}
+
+	ReceiverAnalyticStates[Index] = EHeatAnalyticState::Active;
+	ReceiverAnalyticStartTimes[Index] = SimTime;
+	ReceiverAnalyticStartEnergyJ[Index] = ReceiverEnergyJ[Index];
+	ReceiverAnalyticKeys[Index] = 0;
+
+	BeginAnalyticSegment(Index);
+}
+
+void UHeatSimSubsystem::BeginAnalyticSegment(int32 Index)
+{
+	const int32 NumKeys = FMath::Max(GetDefault<UHeatSimSettings>()->AnalyticTimelineKeys, 1);
+	const int32 Key = FMath::Min(ReceiverAnalyticKeys[Index] + 1, NumKeys);
+	const bool bLastKey = Key == NumKeys;
+
+	// keys split the remaining alpha evenly, each one is placed on the curve by the same solve as the melt time
+	const double TotalJ = ReceiverTotalEnergyJ[Index];
+	const double StartAlpha = ReceiverAnalyticStartEnergyJ[Index] / TotalJ;
+	const double KeyAlpha = bLastKey ? 1.0 : FMath::Lerp(StartAlpha, 1.0, static_cast<double>(Key) / NumKeys);
+	const double KeySeconds = HeatFlux::SolveAnalyticTime(ReceiverAnalyticTerms[Index], (KeyAlpha - StartAlpha) * TotalJ / ReceiverTimeScale[Index]);
+
+	const double Elapsed = SimTime - ReceiverAnalyticStartTimes[Index];
+	const float Delay = static_cast<float>(FMath::Max(KeySeconds - Elapsed, 0.001));
+
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	const int32 ReceiverId = ReceiverSlots.IndexToId[Index];
+	const FTimerDelegate OnDue = bLastKey
+		? FTimerDelegate::CreateUObject(this, &UHeatSimSubsystem::OnAnalyticMeltDue, ReceiverId)
+		: FTimerDelegate::CreateUObject(this, &UHeatSimSubsystem::OnAnalyticKeyDue, ReceiverId);
+	TimerManager.SetTimer(ReceiverMeltTimers[Index], OnDue, Delay, false);
+
+	// the material ramps linearly to 1 at EndTime, so the end is pushed out until the ramp passes through the key
+	const float SegmentStartAlpha = FMath::Clamp(GetAnalyticEnergyJ(Index) / ReceiverTotalEnergyJ[Index], 0.0f, 1.0f);
+	const float SegmentRise = FMath::Max(static_cast<float>(KeyAlpha) - SegmentStartAlpha, UE_KINDA_SMALL_NUMBER);
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	// only pushes material parameters, safe to call from inside the step
+	BeginReceiverTimeline(Index, SegmentStartAlpha, Now, Now + Delay * (1.0f - SegmentStartAlpha) / SegmentRise);
+}
+
+void UHeatSimSubsystem::BeginReceiverTimeline(int32 Index, float StartAlpha, float StartTime, float EndTime)
+{
+	if (!ReceiverActors[Index].IsValid()) return;
+
+	if (IHeatInstancedReceiver* Owner = ReceiverInstanceOwners[Index])
+	{
+		Owner->BeginInstanceMeltTimeline(ReceiverInstanceKeys[Index], StartAlpha, StartTime, EndTime);
+	}
+	else
+	{
+		ReceiverInterfaces[Index]->BeginMeltTimeline(StartAlpha, StartTime, EndTime);
+	}
+}
+
+void UHeatSimSubsystem::EndReceiverTimeline(int32 Index)
+{
+	if (!ReceiverActors[Index].IsValid()) return;
+
+	if (IHeatInstancedReceiver* Owner = ReceiverInstanceOwners[Index])
+	{
+		Owner->EndInstanceMeltTimeline(ReceiverInstanceKeys[Index]);
+	}
+	else
+	{
+		ReceiverInterfaces[Index]->EndMeltTimeline();
+	}
+}
+
+void UHeatSimSubsystem::OnAnalyticKeyDue(int32 ReceiverId)
+{
+	const int32 Index = ReceiverSlots.GetIndex(ReceiverId);
+	if (Index == INDEX_NONE || ReceiverAnalyticStates[Index] != EHeatAnalyticState::Active) return;
+
+	++ReceiverAnalyticKeys[Index];
+	BeginAnalyticSegment(Index);
+}
+
+float UHeatSimSubsystem::GetAnalyticEnergyJ(int32 Index) const
+{
+	const double Elapsed = SimTime - ReceiverAnalyticStartTimes[Index];
+	const double EnergyJ = ReceiverAnalyticStartEnergyJ[Index] + ReceiverTimeScale[Index] * HeatFlux::AnalyticEnergyJ(ReceiverAnalyticTerms[Index], Elapsed);
+	return static_cast<float>(FMath::Min(EnergyJ, static_cast<double>(ReceiverTotalEnergyJ[Index])));
+}
+
+void UHeatSimSubsystem::InvalidateAnalyticMelt(int32 Index)
+{
+	if (!ReceiverAnalyticStates.IsValidIndex(Index)) return;
+
+	const EHeatAnalyticState State = ReceiverAnalyticStates[Index];
+	ReceiverAnalyticStates[Index] = EHeatAnalyticState::Pending;
+	if (State != EHeatAnalyticState::Active) return;
+
+	GetWorld()->GetTimerManager().ClearTimer(ReceiverMeltTimers[Index]);
+
+	ReceiverEnergyJ[Index] = GetAnalyticEnergyJ(Index);
+	ReceiverAlpha[Index] = FMath::Clamp(ReceiverEnergyJ[Index] / ReceiverTotalEnergyJ[Index], 0.0f, 1.0f);
+
+	EndReceiverTimeline(Index);
+	QueueApply(Index, 0.0f, 0.0f, 0.0f);
+}
+
+void UHeatSimSubsystem::InvalidateSourceReceivers(int32 SourceIndex)
+{
+	for (const int32 ReceiverId : SourcePairs[SourceIndex])
+	{
+		InvalidateAnalyticMelt(ReceiverSlots.GetIndex(ReceiverId));
+	}
+}
+
+void UHeatSimSubsystem::OnAnalyticMeltDue(int32 ReceiverId)
+{
+	const int32 Index = ReceiverSlots.GetIndex(ReceiverId);
+	if (Index == INDEX_NONE || ReceiverAnalyticStates[Index] != EHeatAnalyticState::Active) return;
+
+	// the sim clock can trail world time by a step or lag behind after a hitch, re-predict if not there yet
+	const float EnergyJ = GetAnalyticEnergyJ(Index);
+	if (EnergyJ < ReceiverTotalEnergyJ[Index] * 0.9999f)
+	{
+		InvalidateAnalyticMelt(Index);
+		TryBeginAnalyticMelt(Index);
+		return;
+	}
+
+	ReceiverAnalyticStates[Index] = EHeatAnalyticState::Pending;
+	ReceiverEnergyJ[Index] = ReceiverTotalEnergyJ[Index];
+	ReceiverAlpha[Index] = 1.0f;
+
+	// not inside the batch, the receiver may unregister or destroy itself right away
+	const float ElapsedTime = static_cast<float>(SimTime - ReceiverAnalyticStartTimes[Index]);
+	const FPendingApply Apply = { ReceiverActors[Index], ReceiverInterfaces[Index], ReceiverInstanceOwners[Index], ReceiverInstanceKeys[Index],
+		ReceiverTotalEnergyJ[Index], 1.0f, 0.0f, 0.0f, ElapsedTime };
+
+	EndReceiverTimeline(Index);
+	Apply.Dispatch();
+}
+
+void UHeatSimSubsystem::ApplyPendingReceivers()
+{
+	MATERIALSIM_SCOPE(HeatSim_ApplyReceivers);
+	INC_DWORD_STAT_BY(STAT_MaterialSim_Applies, PendingApply.Num());
+
+	// actors may unregister, re-register or invalidate a timeline while applying, which queues into PendingApply again.
+	// Those land in the next frame's batch, this one is dispatched from a local copy
+	const TArray<FPendingApply> Batch = MoveTemp(PendingApply);
+	PendingApply.Reset();
+	PendingApplyIndices.Reset();
+	PendingMassApplyIndices.Reset();
+
+	for (const FPendingApply& Apply : Batch)
+	{
+		Apply.Dispatch();
+	}
+
+	// melt water handed over while applying is placed now, so puddles are not refreshed in the middle of the batch
+	if (UHeatPhaseSubsystem* Phase = GetWorld()->GetSubsystem<UHeatPhaseSubsystem>())
+	{
+		Phase->FlushMeltWater();
+	}
+}
+
+void UHeatSimSubsystem::UpdateOcclusion()
+{
+	MATERIALSIM_SCOPE(HeatSim_UpdateOcclusion);
+
+	const UHeatSimSettings* Settings = GetDefault<UHeatSimSettings>();
+	const int32 NumReceivers = ReceiverActors.Num();
+	if (!Settings->bOcclusion || NumReceivers == 0) return;
+
+	const double MoveThresholdSq = FMath::Square(static_cast<double>(Settings->OcclusionMoveThreshold));
+	int32 Budget = Settings->MaxOcclusionTracesPerFrame;
+
+	// round-robin over the receivers, so a burst of new pairs is traced over several frames
+	for (int32 Visited = 0; Visited < NumReceivers && Budget > 0; ++Visited)
+	{
+		OcclusionCursor = (OcclusionCursor + 1) % NumReceivers;
+		const int32 i = OcclusionCursor;
+
+		if (!ReceiverCanMelt[i] || ReceiverAlpha[i] >= 1.0f) continue;
+
+		for (FHeatContribution& Contribution : ReceiverContributions[i])
+		{
+			if (Budget == 0) break;
+			if (Contribution.TraceState == EHeatTraceState::InFlight) continue;
+
+			const int32 SourceIndex = SourceSlots.GetIndex(Contribution.SourceId);
+			if (SourceIndex == INDEX_NONE) continue;
+
+			const FVector& SourceLocation = SourceLocations[SourceIndex];
+			const FVector& ReceiverLocation = ReceiverLocations[i];
+
+			// the cached visibility stays in use until the new trace comes back
+			if (Contribution.TraceState == EHeatTraceState::Done
+				&& FVector::DistSquared(Contribution.TracedSourceLocation, SourceLocation) <= MoveThresholdSq
+				&& FVector::DistSquared(Contribution.TracedReceiverLocation, ReceiverLocation) <= MoveThresholdSq)
+			{
+				continue;
+			}
+
+			FCollisionQueryParams Params(SCENE_QUERY_STAT(HeatOcclusion), false);
+			if (const AActor* Source = SourceActors[SourceIndex].Get())
+			{
+				Params.AddIgnoredActor(Source);
+			}
+			if (const AActor* Receiver = ReceiverActors[i].Get())
+			{
+				Params.AddIgnoredActor(Receiver);
+			}
+
+			const uint32 Key = ++NextOcclusionTraceKey;
+			OcclusionTraces.Add(Key, { ReceiverSlots.IndexToId[i], Contribution.SourceId, SourceLocation, ReceiverLocation });
+			GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, SourceLocation, ReceiverLocation, Settings->OcclusionChannel,
+				Params, FCollisionResponseParams::DefaultResponseParam, &OcclusionTraceDelegate, Key);
+
+			Contribution.TraceState = EHeatTraceState::InFlight;
+			--Budget;
+		}
+	}
+}
+
+void UHeatSimSubsystem::OnOcclusionTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	FOcclusionTrace Trace;
+	if (!OcclusionTraces.RemoveAndCopyValue(Datum.UserData, Trace)) return;
+
+	// the pair may have ended while the trace was in flight
+	const int32 Index = ReceiverSlots.GetIndex(Trace.ReceiverId);
+	if (Index == INDEX_NONE) return;
+
+	FHeatContribution* Contribution = ReceiverContributions[Index].FindByPredicate([&Trace](const FHeatContribution& C) { return C.SourceId == Trace.SourceId; });
+	if (!Contribution || Contribution->TraceState != EHeatTraceState::InFlight) return;
+
+	const bool bBlocked = Datum.OutHits.ContainsByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; });
+	const float Visibility = bBlocked ? FMath::Clamp(GetDefault<UHeatSimSettings>()->OccludedTransmission, 0.0f, 1.0f) : 1.0f;
+
+	Contribution->TraceState = EHeatTraceState::Done;
+	Contribution->TracedSourceLocation = Trace.SourceLocation;
+	Contribution->TracedReceiverLocation = Trace.ReceiverLocation;
+
+	if (Contribution->Visibility != Visibility)
+	{
+		Contribution->Visibility = Visibility;
+		InvalidateAnalyticMelt(Index);
+	}
+}
+
+void UHeatSimSubsystem::CancelOcclusionTraces(int32 ReceiverId, int32 SourceId)
+{
+	for (TMap<uint32, FOcclusionTrace>::TIterator It = OcclusionTraces.CreateIterator(); It; ++It)
+	{
+		if (It.Value().ReceiverId == ReceiverId || It.Value().SourceId == SourceId)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UHeatSimSubsystem::UpdateMassReceivers(float DeltaTime)
+{
+	MATERIALSIM_SCOPE(HeatSim_UpdateMassReceivers);
+
+	if (NumMassReceivers == 0 || !MassRadiantProcessor) return;
+
+	FMassEntityManager* EntityManager = GetMassEntityManager();
+	if (!EntityManager) return;
+
+	// the processors never touch the source actors, they read a flat copy
+	MassSources.Reset();
+	for (int32 i = 0; i < SourceActors.Num(); ++i)
+	{
+		const ATemperature* Source = SourceActors[i].Get();
+		if (!Source || SourceMaxDistances[i] <= 0.0f || SourcePowerW[i] <= 0.0f) continue;
+
+		MassSources.Locations.Add(SourceLocations[i]);
+		MassSources.PowerW.Add(SourcePowerW[i]);
+		MassSources.MaxDistCm.Add(SourceMaxDistances[i]);
+		MassSources.ClassFilters.Add(Source->IceClassFilter.Get());
+	}
+
+	// without sources nothing can melt, entities keep the power of the last step they were heated in
+	if (MassSources.Num() == 0) return;
+
+	MassRadiantProcessor->Sources = &MassSources;
+
+	FMassProcessingContext ProcessingContext(EntityManager->AsShared(), DeltaTime);
+	UE::Mass::Executor::Run(*MassRadiantProcessor, ProcessingContext);
+	UE::Mass::Executor::Run(*MassMeltProcessor, ProcessingContext);
+
+	MassRadiantProcessor->Sources = nullptr;
+
+	// merged per frame like the packed receivers, the owner only sees the latest state
+	for (const FHeatMassApply& Apply : MassMeltProcessor->ConsumeApplies())
+	{
+		if (const int32* PendingIndex = PendingMassApplyIndices.Find(Apply.Entity))
+		{
+			FPendingApply& Pending = PendingApply[*PendingIndex];
+			Pending.EnergyJ = Apply.EnergyJ;
+			Pending.Alpha = Apply.Alpha;
+			Pending.ReceivedPowerW = Apply.ReceivedPowerW;
+			Pending.DistCm = Apply.DistCm;
+			Pending.DeltaTime += DeltaTime;
+		}
+		else
+		{
+			PendingMassApplyIndices.Add(Apply.Entity, PendingApply.Add({ Apply.Owner.Owner, nullptr, Apply.Owner.Callbacks, Apply.Owner.InstanceKey,
+				Apply.EnergyJ, Apply.Alpha, Apply.ReceivedPowerW, Apply.DistCm, DeltaTime }));
+		}
+	}
+}
+
+void UHeatSimSubsystem::FPendingApply::Dispatch() const
+{
+	if (!Actor.IsValid()) return;
+
+	if (InstanceOwner)
+	{
+		InstanceOwner->ApplyInstanceHeatSimState(InstanceKey, EnergyJ, Alpha, ReceivedPowerW, DistCm, DeltaTime);
+	}
+	else
+	{
+		Receiver->ApplyHeatSimState(EnergyJ, Alpha, ReceivedPowerW, DistCm, DeltaTime);
+	}
+}
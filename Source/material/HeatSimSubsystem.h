@@ -0,0 +1,363 @@
+// HeatSimSubsystem.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/SceneComponent.h"
+#include "WorldCollision.h"
+#include "HeatSpatialHash.h"
+#include "HeatReceiver.h"
+#include "HeatFluxKernel.h"
+#include "HeatNetworkSolver.h"
+#include "HeatMassFragments.h"
+#include "MassArchetypeTypes.h"
+#include "HeatSimSubsystem.generated.h"
+
+class ATemperature;
+class AThermalRoomVolume;
+class UHeatMassRadiantProcessor;
+class UHeatMassMeltProcessor;
+struct FMassEntityManager;
+
+/** Line-of-sight state of a source/receiver pair */
+enum class EHeatTraceState : uint8
+{
+	None,
+	InFlight,
+	Done
+};
+
+/** One source currently heating a receiver and the power it delivered on the last step */
+struct FHeatContribution
+{
+	int32 SourceId = INDEX_NONE;
+	float PowerW = 0.0f;
+
+	/** Fraction of the source's power reaching the receiver, from the last line-of-sight trace */
+	float Visibility = 1.0f;
+	EHeatTraceState TraceState = EHeatTraceState::None;
+
+	/** Endpoints of the last trace */
+	FVector TracedSourceLocation = FVector::ZeroVector;
+	FVector TracedReceiverLocation = FVector::ZeroVector;
+};
+
+/** Most receivers sit next to one or two sources, so the list lives inline with the receiver */
+using FHeatContributionList = TArray<FHeatContribution, TInlineAllocator<4>>;
+
+/** Analytic melt state of a receiver */
+enum class EHeatAnalyticState : uint8
+{
+	/** Integrated every step, tried for analytic melt at the end of the step */
+	Pending,
+	/** Melt completion is scheduled, the receiver is skipped by the step */
+	Active,
+	/** Cannot be predicted (e.g. inside a conduction room), integrated every step until its setup changes */
+	Ineligible
+};
+
+using FHeatAnalyticTermList = TArray<FHeatAnalyticTerm, TInlineAllocator<4>>;
+
+/** Something thermal vision should show, gathered from the sim for UThermalTextureSubsystem */
+struct FHeatThermalPoint
+{
+	FVector Location;
+	float TemperatureC;
+	bool bSource;
+};
+
+/** Stable id <-> packed index table for the struct-of-arrays storage below */
+struct FHeatSlotMap
+{
+	TArray<int32> IdToIndex;
+	TArray<int32> IndexToId;
+	TArray<int32> FreeIds;
+
+	int32 Add();
+
+	/** Removes the slot and returns the id that was moved into its index, or INDEX_NONE */
+	int32 RemoveAtSwap(int32 Id, int32& OutIndex);
+
+	int32 GetIndex(int32 Id) const
+	{
+		return IdToIndex.IsValidIndex(Id) ? IdToIndex[Id] : INDEX_NONE;
+	}
+
+	int32 Num() const { return IndexToId.Num(); }
+};
+
+/**
+ *  Owns every heat source and receiver in the world and advances them in batched fixed-length steps
+ *  (see UHeatSimSettings), so melt results do not depend on the frame rate.
+ *  Sources and receivers are kept in packed parallel arrays so the inner loop never touches the actors.
+ *  Source/receiver pairs are found through a spatial hash that is only updated when something moves.
+ *  Every actor implementing IHeatReceiver is registered automatically when play begins or when it is spawned.
+ */
+UCLASS()
+class MATERIAL_API UHeatSimSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	int32 RegisterSource(ATemperature* Source);
+	void UnregisterSource(int32 SourceId);
+
+	/** Forces pair discovery for a source, e.g. after its heat radius changed */
+	void MarkSourceDirty(int32 SourceId);
+
+	/** Resumes advancing a dormant source and refreshes its power and pairs on the next step */
+	void WakeSource(int32 SourceId);
+
+	/**
+	 *  Registers an IHeatReceiver, or refreshes its thermal body if it is already registered. While an analytic melt runs the
+	 *  predicted energy wins over the one the receiver reports, unless bAuthoritativeEnergy is set, e.g. after a reset or restore
+	 */
+	UFUNCTION(BlueprintCallable, Category="Heat")
+	void RegisterReceiver(AActor* Receiver, bool bAuthoritativeEnergy = false);
+
+	UFUNCTION(BlueprintCallable, Category="Heat")
+	void UnregisterReceiver(AActor* Receiver);
+
+	/** Adds a source to the receiver's contribution list. Flux from every listed source is summed */
+	void AddReceiverSource(const AActor* Receiver, ATemperature* Source);
+
+	void RemoveReceiverSource(const AActor* Receiver, ATemperature* Source);
+
+	/**
+	 *  Registers one body of an instanced receiver, e.g. a block of an AIceField. InstanceKey is passed back in every callback.
+	 *  Pairs are found like for any receiver, but the owner is not sent StartHeating/StopHeating. Returns the receiver id.
+	 */
+	int32 RegisterReceiverInstance(AActor* Owner, IHeatInstancedReceiver* Callbacks, int32 InstanceKey, const FVector& Location, const FHeatReceiverBody& Body, float EnergyAccumJ);
+	void UnregisterReceiverInstance(int32 ReceiverId);
+
+	/** Instanced bodies are not tracked through their owner's transform, the owner reports moves itself */
+	void MoveReceiverInstance(int32 ReceiverId, const FVector& NewLocation);
+
+	/**
+	 *  Same as RegisterReceiverInstance, but the body lives as a Mass entity and is integrated by the heat Mass processors
+	 *  in parallel chunks. Meant for very large fields; no pairs, rooms or analytic melt, just radiant heating from every source.
+	 */
+	FMassEntityHandle CreateMassReceiver(AActor* Owner, IHeatInstancedReceiver* Callbacks, int32 InstanceKey, const FVector& Location, const FHeatReceiverBody& Body, float EnergyAccumJ);
+	void DestroyMassReceiver(FMassEntityHandle Entity);
+	void MoveMassReceiver(FMassEntityHandle Entity, const FVector& NewLocation);
+
+	/** Current melt energy of a Mass receiver, e.g. to carry it over when the block is promoted to an actor */
+	float GetMassReceiverEnergyJ(FMassEntityHandle Entity) const;
+
+	/** Rooms with a voxel grid get stepped every frame and add conduction to the receivers inside them */
+	void RegisterRoom(AThermalRoomVolume* Room);
+	void UnregisterRoom(AThermalRoomVolume* Room);
+
+	/** Appends every live source at its temperature and every meltable receiver at the melting point */
+	void GatherThermalPoints(TArray<FHeatThermalPoint>& OutPoints) const;
+
+	const TArray<TWeakObjectPtr<AThermalRoomVolume>>& GetRooms() const { return Rooms; }
+
+	/** Returns every receiver currently within range of the source */
+	TArray<TScriptInterface<IHeatReceiver>> GetReceiversInRange(const ATemperature* Source) const;
+
+private:
+
+	void RemoveSourceAt(int32 Index);
+	int32 AddReceiverSlot(AActor* Owner, IHeatReceiver* Interface, const FVector& Location, const FHeatReceiverBody& Body, float EnergyAccumJ);
+	void RemoveReceiverById(int32 ReceiverId);
+	void RemoveReceiverAt(int32 Index);
+	void SetReceiverLocation(int32 ReceiverId, const FVector& NewLocation);
+
+	void OnActorSpawned(AActor* Actor);
+
+	UFUNCTION()
+	void OnReceiverEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+	void OnSourceMoved(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport, int32 SourceId);
+	void OnReceiverMoved(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport, int32 ReceiverId);
+
+	void OnSourceLODChanged(float Interval, int32 SourceId);
+	void OnReceiverLODChanged(float Interval, int32 ReceiverId);
+
+	/** Runs one fixed-length sim step */
+	void StepSimulation(float StepTime);
+
+	void UpdateSources(float DeltaTime);
+
+	/** Visuals of the sources advanced by this frame's steps, once per frame however many steps ran */
+	void UpdateSourceVisuals();
+	void UpdateRooms(float DeltaTime);
+	void UpdatePairs();
+	void UpdateReceivers(float DeltaTime);
+
+	/** Implicit alternative to UpdateReceivers, see UHeatSimSettings::bThermalNetwork */
+	void UpdateReceiverNetwork(float DeltaTime);
+
+	/** Radiant power of every pair into the contributions, ReceiverPowerW and ReceiverNearestDistCm */
+	void GatherReceivedPower();
+	void ApplyPendingReceivers();
+
+	/** Starts async line-of-sight traces for new and moved pairs, within the per-frame budget */
+	void UpdateOcclusion();
+	void OnOcclusionTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	/** Drops in-flight traces of a removed receiver or source, their ids may be reused before the results come back */
+	void CancelOcclusionTraces(int32 ReceiverId, int32 SourceId);
+
+	/** Runs the heat Mass processors over every Mass receiver against the current sources */
+	void UpdateMassReceivers(float DeltaTime);
+	FMassEntityManager* GetMassEntityManager() const;
+
+	/** Merges a receiver state into this frame's pending applies */
+	void QueueApply(int32 Index, float PowerW, float DistCm, float DeltaTime);
+
+	void TryBeginAnalyticMelt(int32 Index);
+
+	/** Bakes the analytic energy up to now and drops the receiver back to per-step integration */
+	void InvalidateAnalyticMelt(int32 Index);
+	void InvalidateSourceReceivers(int32 SourceIndex);
+	float GetAnalyticEnergyJ(int32 Index) const;
+	bool IsInsideRoom(const FVector& Location) const;
+	void OnAnalyticMeltDue(int32 ReceiverId);
+	void BeginReceiverTimeline(int32 Index, float StartAlpha, float StartTime, float EndTime);
+	void EndReceiverTimeline(int32 Index);
+
+	/** Room whose grid contains the location, and the voxel's excess over that room's ambient temperature */
+	const AThermalRoomVolume* FindRoom(const FVector& Location, float& OutExcessTemperature) const;
+
+	/** Aims the receiver's timeline at its next key of the predicted curve and arms the timer for it */
+	void BeginAnalyticSegment(int32 Index);
+	void OnAnalyticKeyDue(int32 ReceiverId);
+
+	void RebuildSpatialHash(float NewCellSize);
+	bool IsPairInRange(int32 SourceIndex, int32 ReceiverIndex) const;
+	void DispatchPairEvents();
+
+	FHeatSlotMap SourceSlots;
+	TArray<TWeakObjectPtr<ATemperature>> SourceActors;
+	TArray<FVector> SourceLocations;
+	TArray<float> SourceMaxDistances;
+	TArray<float> SourcePowerW;
+	TArray<uint8> SourceAwake;
+	TArray<TSet<int32>> SourcePairs;
+	TArray<FDelegateHandle> SourceMoveHandles;
+	TArray<float> SourceUpdateIntervals;
+	TArray<float> SourceAccumTimes;
+	TArray<uint8> SourceVisualsDirty;
+
+	FHeatSlotMap ReceiverSlots;
+	TArray<TWeakObjectPtr<AActor>> ReceiverActors;
+	TArray<IHeatReceiver*> ReceiverInterfaces;
+	TArray<IHeatInstancedReceiver*> ReceiverInstanceOwners;
+	TArray<int32> ReceiverInstanceKeys;
+	TArray<FVector> ReceiverLocations;
+	TArray<FIntVector> ReceiverCells;
+	TArray<float> ReceiverAreaM2;
+	TArray<float> ReceiverTotalEnergyJ;
+	TArray<float> ReceiverTimeScale;
+	TArray<float> ReceiverEnergyJ;
+	TArray<float> ReceiverAlpha;
+	TArray<FHeatContributionList> ReceiverContributions;
+	TArray<uint8> ReceiverCanMelt;
+	TArray<FDelegateHandle> ReceiverMoveHandles;
+	TArray<float> ReceiverApplyIntervals;
+	TArray<float> ReceiverApplyAccumTimes;
+	TArray<EHeatAnalyticState> ReceiverAnalyticStates;
+	TArray<double> ReceiverAnalyticStartTimes;
+	TArray<float> ReceiverAnalyticStartEnergyJ;
+	TArray<int32> ReceiverAnalyticKeys;
+	TArray<FHeatAnalyticTermList> ReceiverAnalyticTerms;
+	TArray<FTimerHandle> ReceiverMeltTimers;
+	TMap<TObjectKey<AActor>, int32> ReceiverIdsByActor;
+
+	FHeatSpatialHash ReceiverHash;
+
+	TArray<TWeakObjectPtr<AThermalRoomVolume>> Rooms;
+
+	TSet<int32> DirtySourceIds;
+	TSet<int32> DirtyReceiverIds;
+
+	/** Pair changes found during discovery, forwarded to the receivers once the packed arrays are consistent */
+	struct FPairEvent
+	{
+		int32 ReceiverId;
+		TWeakObjectPtr<ATemperature> Source;
+		bool bEnter;
+	};
+
+	void AddPair(int32 ReceiverIndex, int32 SourceIndex);
+	void RemovePair(int32 ReceiverIndex, int32 SourceIndex);
+	TArray<FPairEvent> PendingPairEvents;
+
+	/** Receivers whose state changed this frame, applied to the actors after the batch */
+	struct FPendingApply
+	{
+		TWeakObjectPtr<AActor> Actor;
+		IHeatReceiver* Receiver;
+		IHeatInstancedReceiver* InstanceOwner;
+		int32 InstanceKey;
+		float EnergyJ;
+		float Alpha;
+		float ReceivedPowerW;
+		float DistCm;
+		float DeltaTime;
+
+		void Dispatch() const;
+	};
+	TArray<FPendingApply> PendingApply;
+	TMap<int32, int32> PendingApplyIndices;
+	TMap<FMassEntityHandle, int32> PendingMassApplyIndices;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UHeatMassRadiantProcessor> MassRadiantProcessor;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UHeatMassMeltProcessor> MassMeltProcessor;
+
+	FMassArchetypeHandle MassReceiverArchetype;
+	FHeatMassSourceSnapshot MassSources;
+	int32 NumMassReceivers = 0;
+
+	/** Real time not yet consumed by a fixed step */
+	double StepAccumulator = 0.0;
+
+	/** Total simulated time, the clock analytic predictions are measured against */
+	double SimTime = 0.0;
+
+	/** Per-frame scratch for the flux kernel, kept around to avoid reallocating */
+	FHeatPairBatch PairBatch;
+	TArray<int32> PairReceiverIndices;
+	TArray<float> PairPowerW;
+	TArray<float> PairDistCm;
+	TArray<float> ReceiverPowerW;
+	TArray<float> ReceiverNearestDistCm;
+
+	/** Network scratch, kept around to avoid reallocating */
+	FHeatNetworkSystem NetworkSystem;
+	TArray<double> NetworkTemperatures;
+	TArray<int32> NetworkReceivers;
+	TArray<int32> NetworkNodeOfReceiver;
+	TArray<int32> NetworkCandidates;
+
+	/** Simulated time not yet consumed by a network solve */
+	float NetworkAccumulator = 0.0f;
+
+	FDelegateHandle ActorSpawnedHandle;
+
+	/** A trace in flight, keyed by the user data passed to the async trace */
+	struct FOcclusionTrace
+	{
+		int32 ReceiverId;
+		int32 SourceId;
+		FVector SourceLocation;
+		FVector ReceiverLocation;
+	};
+	TMap<uint32, FOcclusionTrace> OcclusionTraces;
+	uint32 NextOcclusionTraceKey = 0;
+	int32 OcclusionCursor = 0;
+	FTraceDelegate OcclusionTraceDelegate;
+};
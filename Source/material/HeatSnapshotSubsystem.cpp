@@ -0,0 +1,267 @@
+// HeatSnapshotSubsystem.cpp
+
+#include "HeatSnapshotSubsystem.h"
+
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Components/StaticMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "ActorPoolSubsystem.h"
+#include "HeatPhaseSubsystem.h"
+#include "Ice.h"
+#include "Transformation_actor.h"
+#include "Temperature.h"
+#include "MaterialSimStats.h"
+#include "material.h"
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorld CmdHeatSnapshotSave(
+	TEXT("heat.Snapshot.Save"),
+	TEXT("Saves the thermal and form state of the world as the checkpoint."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UHeatSnapshotSubsystem* Snapshot = World ? World->GetSubsystem<UHeatSnapshotSubsystem>() : nullptr)
+		{
+			Snapshot->SaveCheckpoint();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld CmdHeatSnapshotRestore(
+	TEXT("heat.Snapshot.Restore"),
+	TEXT("Restores the thermal and form state saved by the last checkpoint."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UHeatSnapshotSubsystem* Snapshot = World ? World->GetSubsystem<UHeatSnapshotSubsystem>() : nullptr)
+		{
+			Snapshot->RestoreCheckpoint();
+		}
+	}));
+#endif
+
+namespace HeatSnapshot
+{
+	constexpr uint32 Magic = 0x50534854;
+
+	enum EVersion : int32
+	{
+		Initial = 1,
+
+		LatestPlusOne,
+		Latest = LatestPlusOne - 1
+	};
+
+	/** AIce or ATransformation_actor. Form is only used by the latter */
+	struct FBlockRecord
+	{
+		FName Name;
+		FVector3f Location = FVector3f::ZeroVector;
+		FQuat4f Rotation = FQuat4f::Identity;
+		FVector3f UnmeltedScale = FVector3f::OneVector;
+		float MeltAlpha = 0.0f;
+		float EnergyAccumJ = 0.0f;
+		uint8 Form = 0;
+		uint8 bParked = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FBlockRecord& Record)
+		{
+			return Ar << Record.Name << Record.Location << Record.Rotation << Record.UnmeltedScale
+				<< Record.MeltAlpha << Record.EnergyAccumJ << Record.Form << Record.bParked;
+		}
+	};
+
+	struct FSourceRecord
+	{
+		FName Name;
+		float Temperature = 0.0f;
+
+		friend FArchive& operator<<(FArchive& Ar, FSourceRecord& Record)
+		{
+			return Ar << Record.Name << Record.Temperature;
+		}
+	};
+
+	/** Live actors of a class by name, for matching records on restore */
+	template<typename T>
+	TMap<FName, T*> MapByName(UWorld* World)
+	{
+		TMap<FName, T*> Map;
+		for (TActorIterator<T> It(World); It; ++It)
+		{
+			Map.Add(It->GetFName(), *It);
+		}
+		return Map;
+	}
+
+	/** Brings a block back out of the pool or parks it, as recorded. True if it is in play afterwards */
+	bool RestorePooling(UActorPoolSubsystem* Pool, AActor* Actor, const FBlockRecord& Record)
+	{
+		const bool bParkedNow = Pool && Pool->IsParked(Actor);
+		if (Record.bParked)
+		{
+			if (Pool && !bParkedNow)
+			{
+				Pool->Release(Actor);
+			}
+			return false;
+		}
+
+		const FTransform Transform(FQuat(Record.Rotation), FVector(Record.Location), FVector(Record.UnmeltedScale));
+		if (bParkedNow)
+		{
+			Pool->Reclaim(Actor, Transform);
+		}
+		else
+		{
+			Actor->SetActorLocationAndRotation(Transform.GetLocation(), Transform.GetRotation(), false, nullptr, ETeleportType::ResetPhysics);
+		}
+		return true;
+	}
+}
+
+bool UHeatSnapshotSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UHeatSnapshotSubsystem::SaveCheckpoint()
+{
+	const double Start = FPlatformTime::Seconds();
+	SaveSnapshot(Checkpoint);
+
+	UE_LOG(Logmaterial, Log, TEXT("heat snapshot: saved %d bytes in %.3f ms"), Checkpoint.Num(), (FPlatformTime::Seconds() - Start) * 1000.0);
+}
+
+bool UHeatSnapshotSubsystem::RestoreCheckpoint()
+{
+	if (!HasCheckpoint()) return false;
+
+	const double Start = FPlatformTime::Seconds();
+	const bool bRestored = LoadSnapshot(Checkpoint);
+
+	UE_LOG(Logmaterial, Log, TEXT("heat snapshot: restored %d bytes in %.3f ms"), Checkpoint.Num(), (FPlatformTime::Seconds() - Start) * 1000.0);
+	return bRestored;
+}
+
+void UHeatSnapshotSubsystem::SaveSnapshot(TArray<uint8>& OutData)
+{
+	OutData.Reset();
+	FMemoryWriter Writer(OutData);
+	SerializeThermalState(Writer);
+}
+
+bool UHeatSnapshotSubsystem::LoadSnapshot(const TArray<uint8>& Data)
+{
+	FMemoryReader Reader(Data);
+	SerializeThermalState(Reader);
+
+	if (Reader.IsError())
+	{
+		UE_LOG(Logmaterial, Warning, TEXT("heat snapshot: not a snapshot or from a newer version, nothing restored"));
+		return false;
+	}
+	return true;
+}
+
+void UHeatSnapshotSubsystem::SerializeThermalState(FArchive& Ar)
+{
+	using namespace HeatSnapshot;
+
+	MATERIALSIM_SCOPE(Snapshot_Serialize);
+
+	UWorld* World = GetWorld();
+	UActorPoolSubsystem* Pool = World->GetSubsystem<UActorPoolSubsystem>();
+
+	uint32 FileMagic = Magic;
+	int32 Version = Latest;
+	Ar << FileMagic << Version;
+
+	if (Ar.IsLoading() && (FileMagic != Magic || Version > Latest))
+	{
+		Ar.SetError();
+		return;
+	}
+
+	TArray<FBlockRecord> IceRecords;
+	TArray<FBlockRecord> FormRecords;
+	TArray<FSourceRecord> SourceRecords;
+
+	if (Ar.IsSaving())
+	{
+		for (TActorIterator<AIce> It(World); It; ++It)
+		{
+			FBlockRecord& Record = IceRecords.AddDefaulted_GetRef();
+			Record.Name = It->GetFName();
+			Record.Location = FVector3f(It->GetActorLocation());
+			Record.Rotation = FQuat4f(It->GetActorQuat());
+			Record.UnmeltedScale = FVector3f(It->InitialScale);
+			Record.MeltAlpha = It->MeltAlpha;
+			Record.EnergyAccumJ = It->EnergyAccumJ;
+			Record.bParked = Pool && Pool->IsParked(*It);
+		}
+
+		for (TActorIterator<ATransformation_actor> It(World); It; ++It)
+		{
+			FBlockRecord& Record = FormRecords.AddDefaulted_GetRef();
+			Record.Name = It->GetFName();
+			Record.Location = FVector3f(It->GetActorLocation());
+			Record.Rotation = FQuat4f(It->GetActorQuat());
+			Record.UnmeltedScale = FVector3f(It->GetBaseScaleBeforeMelt());
+			Record.MeltAlpha = It->GetMeltAlpha();
+			Record.EnergyAccumJ = It->GetEnergyAccumJ();
+			Record.Form = static_cast<uint8>(It->CurrentForm);
+			Record.bParked = Pool && Pool->IsParked(*It);
+		}
+
+		for (TActorIterator<ATemperature> It(World); It; ++It)
+		{
+			SourceRecords.Add({ It->GetFName(), It->Temperature });
+		}
+	}
+
+	Ar << IceRecords << FormRecords << SourceRecords;
+
+	if (!Ar.IsLoading() || Ar.IsError()) return;
+
+	// the water of the restored melt is already accounted for in the blocks
+	if (UHeatPhaseSubsystem* Phase = World->GetSubsystem<UHeatPhaseSubsystem>())
+	{
+		Phase->ClearWater();
+	}
+
+	const TMap<FName, AIce*> IceByName = MapByName<AIce>(World);
+	for (const FBlockRecord& Record : IceRecords)
+	{
+		AIce* Ice = IceByName.FindRef(Record.Name);
+		if (!Ice || !RestorePooling(Pool, Ice, Record)) continue;
+
+		Ice->RestoreMelt(FVector(Record.UnmeltedScale), Record.EnergyAccumJ, Record.MeltAlpha);
+	}
+
+	const TMap<FName, ATransformation_actor*> FormByName = MapByName<ATransformation_actor>(World);
+	for (const FBlockRecord& Record : FormRecords)
+	{
+		ATransformation_actor* Block = FormByName.FindRef(Record.Name);
+		if (!Block || !RestorePooling(Pool, Block, Record)) continue;
+
+		Block->RestoreThermalState(static_cast<EBlockForm>(Record.Form), Record.EnergyAccumJ, Record.MeltAlpha, FVector(Record.UnmeltedScale));
+
+		// the spec may have turned physics back on, the block should not carry on falling from before
+		if (Block->MeshComp && Block->MeshComp->IsSimulatingPhysics())
+		{
+			Block->MeshComp->SetPhysicsLinearVelocity(FVector::ZeroVector);
+			Block->MeshComp->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+		}
+	}
+
+	const TMap<FName, ATemperature*> SourceByName = MapByName<ATemperature>(World);
+	for (const FSourceRecord& Record : SourceRecords)
+	{
+		if (ATemperature* Source = SourceByName.FindRef(Record.Name))
+		{
+			Source->SetTemperature(Record.Temperature);
+		}
+	}
+}
@@ -0,0 +1,47 @@
+// HeatSnapshotSubsystem.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HeatSnapshotSubsystem.generated.h"
+
+/**
+ *  Saves and restores the thermal and form state of every AIce, ATransformation_actor and ATemperature in the world
+ *  as one versioned binary blob, so a puzzle room can be put back without reloading the level.
+ *  Actors are matched by name and restored in place; blocks melted back into the actor pool since are reclaimed,
+ *  puddles are cleared. Actors spawned after the save are left alone.
+ */
+UCLASS()
+class MATERIAL_API UHeatSnapshotSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Keeps the current state as the checkpoint to restore */
+	UFUNCTION(BlueprintCallable, Category="Heat|Snapshot")
+	void SaveCheckpoint();
+
+	/** Puts the world back to the last checkpoint. False when none was saved */
+	UFUNCTION(BlueprintCallable, Category="Heat|Snapshot")
+	bool RestoreCheckpoint();
+
+	UFUNCTION(BlueprintPure, Category="Heat|Snapshot")
+	bool HasCheckpoint() const { return Checkpoint.Num() > 0; }
+
+	/** Writes the current state to OutData */
+	void SaveSnapshot(TArray<uint8>& OutData);
+
+	/** Restores a blob written by SaveSnapshot. False if it is not one or from a newer version */
+	bool LoadSnapshot(const TArray<uint8>& Data);
+
+	/** Writes the state when Ar is saving, reads and applies it when loading */
+	void SerializeThermalState(FArchive& Ar);
+
+private:
+
+	TArray<uint8> Checkpoint;
+};
@@ -0,0 +1,63 @@
+// HeatSpatialHash.cpp
+
+#include "HeatSpatialHash.h"
+
+void FHeatSpatialHash::Reset(float NewCellSize)
+{
+	CellSize = FMath::Max(NewCellSize, 1.0f);
+	Cells.Reset();
+}
+
+FIntVector FHeatSpatialHash::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize),
+		FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+void FHeatSpatialHash::Insert(int32 Id, const FIntVector& Cell)
+{
+	Cells.FindOrAdd(Cell).Add(Id);
+}
+
+void FHeatSpatialHash::Remove(int32 Id, const FIntVector& Cell)
+{
+	if (TArray<int32>* Ids = Cells.Find(Cell))
+	{
+		Ids->RemoveSingleSwap(Id, EAllowShrinking::No);
+		if (Ids->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+bool FHeatSpatialHash::Move(int32 Id, const FIntVector& OldCell, const FIntVector& NewCell)
+{
+	if (OldCell == NewCell) return false;
+
+	Remove(Id, OldCell);
+	Insert(Id, NewCell);
+	return true;
+}
+
+void FHeatSpatialHash::Query(const FVector& Center, float Radius, TArray<int32>& OutIds) const
+{
+	const FIntVector Min = GetCell(Center - FVector(Radius));
+	const FIntVector Max = GetCell(Center + FVector(Radius));
+
+	for (int32 Z = Min.Z; Z <= Max.Z; ++Z)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			for (int32 X = Min.X; X <= Max.X; ++X)
+			{
+				if (const TArray<int32>* Ids = Cells.Find(FIntVector(X, Y, Z)))
+				{
+					OutIds.Append(*Ids);
+				}
+			}
+		}
+	}
+}
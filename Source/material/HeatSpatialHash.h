@@ -0,0 +1,31 @@
+// HeatSpatialHash.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ *  Uniform spatial hash of heat receiver ids.
+ *  Cells are sized to the largest source MaxHeatDistance so a source query touches at most a 3x3x3 block.
+ */
+struct FHeatSpatialHash
+{
+	void Reset(float NewCellSize);
+
+	float GetCellSize() const { return CellSize; }
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	void Insert(int32 Id, const FIntVector& Cell);
+	void Remove(int32 Id, const FIntVector& Cell);
+
+	/** Moves an id between cells. Returns false if the cell did not change */
+	bool Move(int32 Id, const FIntVector& OldCell, const FIntVector& NewCell);
+
+	/** Appends every id stored in a cell overlapping the sphere. Callers still need an exact distance test */
+	void Query(const FVector& Center, float Radius, TArray<int32>& OutIds) const;
+
+private:
+	float CellSize = 500.0f;
+	TMap<FIntVector, TArray<int32>> Cells;
+};
@@ -0,0 +1,261 @@
+// HeatTelemetry.cpp
+
+#include "HeatTelemetry.h"
+
+#include "Engine/Engine.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "material.h"
+
+static TAutoConsoleVariable<int32> CVarHeatTelemetryDump(
+	TEXT("heat.Telemetry.Dump"),
+	0,
+	TEXT("Writes melt telemetry to Saved/Telemetry. 0 off, 1 CSV, 2 binary (FHeatTelemetryRecord after an 8 byte header)."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarHeatTelemetrySummary(
+	TEXT("heat.Telemetry.Summary"),
+	0,
+	TEXT("1 shows one on-screen line aggregating the melt telemetry of the last drain window."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarHeatTelemetryInterval(
+	TEXT("heat.Telemetry.Interval"),
+	0.25f,
+	TEXT("Seconds between telemetry drains."),
+	ECVF_Default);
+
+#if !UE_BUILD_SHIPPING
+static TAutoConsoleVariable<int32> CVarHeatTelemetryBlockText(
+	TEXT("heat.Telemetry.BlockText"),
+	0,
+	TEXT("1 also prints every telemetry record as per-block on-screen text. Slow with many blocks, not in Shipping."),
+	ECVF_Default);
+
+bool FHeatTelemetry::ShowBlockText()
+{
+	return GEngine && CVarHeatTelemetryBlockText.GetValueOnGameThread() != 0;
+}
+#endif
+
+FHeatTelemetry& FHeatTelemetry::Get()
+{
+	static FHeatTelemetry Instance;
+	return Instance;
+}
+
+FHeatTelemetry::FHeatTelemetry()
+	: Slots(MakeUnique<FSlot[]>(Capacity))
+{
+	Scratch.Reserve(Capacity);
+
+	if (FPlatformProcess::SupportsMultithreading())
+	{
+		WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+		Thread = FRunnableThread::Create(this, TEXT("HeatTelemetryDumper"), 0, TPri_Lowest);
+	}
+
+	// the static instance is destroyed too late to join a thread
+	FCoreDelegates::OnEnginePreExit.AddRaw(this, &FHeatTelemetry::Shutdown);
+}
+
+FHeatTelemetry::~FHeatTelemetry()
+{
+	Shutdown();
+}
+
+void FHeatTelemetry::Shutdown()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+	if (WakeEvent)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+	}
+	CloseDump();
+}
+
+void FHeatTelemetry::Record(const FHeatTelemetryRecord& InRecord)
+{
+	const uint64 Index = WriteCursor.fetch_add(1, std::memory_order_relaxed);
+	FSlot& Slot = Slots[Index & (Capacity - 1)];
+
+	// a lapped slot reads as in progress until this write is published
+	Slot.Sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	Slot.Record = InRecord;
+	Slot.Record.Time = FPlatformTime::Seconds() - GStartTime;
+
+	Slot.Sequence.store(Index + 1, std::memory_order_release);
+}
+
+uint32 FHeatTelemetry::Run()
+{
+	while (!bStopping.load(std::memory_order_relaxed))
+	{
+		WakeEvent->Wait(FTimespan::FromSeconds(FMath::Max(CVarHeatTelemetryInterval.GetValueOnAnyThread(), 0.01f)));
+		Drain();
+	}
+
+	Drain();
+	return 0;
+}
+
+void FHeatTelemetry::Stop()
+{
+	bStopping.store(true, std::memory_order_relaxed);
+	if (WakeEvent)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+void FHeatTelemetry::Drain()
+{
+	const uint64 End = WriteCursor.load(std::memory_order_acquire);
+
+	// producers lapped the dumper, the oldest records are gone
+	if (End - ReadCursor > Capacity)
+	{
+		NumDropped.fetch_add(End - ReadCursor - Capacity, std::memory_order_relaxed);
+		ReadCursor = End - Capacity;
+	}
+
+	Scratch.Reset();
+	while (ReadCursor < End)
+	{
+		const FSlot& Slot = Slots[ReadCursor & (Capacity - 1)];
+
+		const uint64 Before = Slot.Sequence.load(std::memory_order_acquire);
+		if (Before == 0 || Before < ReadCursor + 1)
+		{
+			// claimed but not published yet, picked up on the next drain
+			break;
+		}
+
+		const FHeatTelemetryRecord Copy = Slot.Record;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64 After = Slot.Sequence.load(std::memory_order_relaxed);
+
+		if (Before == ReadCursor + 1 && After == Before)
+		{
+			Scratch.Add(Copy);
+		}
+		else
+		{
+			NumDropped.fetch_add(1, std::memory_order_relaxed);
+		}
+		++ReadCursor;
+	}
+
+	WriteRecords(Scratch);
+
+	FHeatTelemetrySummary Window;
+	TSet<uint32> Objects;
+	double AlphaSum = 0.0;
+	for (const FHeatTelemetryRecord& Record : Scratch)
+	{
+		Objects.Add(Record.ObjectId);
+		Window.MaxPowerW = FMath::Max(Window.MaxPowerW, Record.PowerW);
+		Window.NumMelted += Record.MeltAlpha >= 1.0f ? 1 : 0;
+		AlphaSum += Record.MeltAlpha;
+	}
+	Window.NumRecords = Scratch.Num();
+	Window.NumObjects = Objects.Num();
+	Window.AvgMeltAlpha = Scratch.Num() > 0 ? static_cast<float>(AlphaSum / Scratch.Num()) : 0.0f;
+	Window.NumDropped = NumDropped.load(std::memory_order_relaxed);
+
+	FScopeLock Lock(&SummaryLock);
+	Summary = Window;
+}
+
+void FHeatTelemetry::WriteRecords(TConstArrayView<FHeatTelemetryRecord> Records)
+{
+	const int32 Mode = CVarHeatTelemetryDump.GetValueOnAnyThread();
+	if (Mode != DumpMode)
+	{
+		CloseDump();
+		DumpMode = Mode;
+
+		if (DumpMode == 1 || DumpMode == 2)
+		{
+			const FString Path = FPaths::ProjectSavedDir() / TEXT("Telemetry") / FString::Printf(TEXT("HeatTelemetry_%s.%s"),
+				*FDateTime::Now().ToString(), DumpMode == 1 ? TEXT("csv") : TEXT("bin"));
+			DumpFile.Reset(IFileManager::Get().CreateFileWriter(*Path));
+
+			if (!DumpFile)
+			{
+				UE_LOG(Logmaterial, Warning, TEXT("heat telemetry: could not open %s"), *Path);
+			}
+			else if (DumpMode == 1)
+			{
+				static const ANSICHAR Header[] = "Time,Object,DistCm,PowerW,EnergyJ,MeltAlpha,Scale\n";
+				DumpFile->Serialize(const_cast<ANSICHAR*>(Header), sizeof(Header) - 1);
+			}
+			else
+			{
+				uint32 Magic = 0x48544C4D;
+				uint32 RecordSize = sizeof(FHeatTelemetryRecord);
+				*DumpFile << Magic << RecordSize;
+			}
+		}
+	}
+
+	if (!DumpFile || Records.Num() == 0) return;
+
+	if (DumpMode == 1)
+	{
+		TAnsiStringBuilder<16384> Text;
+		for (const FHeatTelemetryRecord& Record : Records)
+		{
+			Text.Appendf("%.4f,%u,%.1f,%.2f,%.1f,%.4f,%.3f\n", Record.Time, Record.ObjectId, Record.DistCm, Record.PowerW, Record.EnergyJ, Record.MeltAlpha, Record.Scale);
+			if (Text.Len() > 15000)
+			{
+				DumpFile->Serialize(Text.GetData(), Text.Len());
+				Text.Reset();
+			}
+		}
+		DumpFile->Serialize(Text.GetData(), Text.Len());
+	}
+	else
+	{
+		DumpFile->Serialize(const_cast<FHeatTelemetryRecord*>(Records.GetData()), Records.Num() * sizeof(FHeatTelemetryRecord));
+	}
+}
+
+void FHeatTelemetry::CloseDump()
+{
+	if (DumpFile)
+	{
+		DumpFile->Close();
+		DumpFile.Reset();
+	}
+}
+
+FHeatTelemetrySummary FHeatTelemetry::GetSummary() const
+{
+	FScopeLock Lock(&SummaryLock);
+	return Summary;
+}
+
+void FHeatTelemetry::DrawSummary() const
+{
+	if (!GEngine || CVarHeatTelemetrySummary.GetValueOnGameThread() == 0) return;
+
+	const FHeatTelemetrySummary Window = GetSummary();
+	GEngine->AddOnScreenDebugMessage(reinterpret_cast<uint64>(this), 0.0f, FColor::Cyan, FString::Printf(
+		TEXT("Melt telemetry: %d blocks, %d records, %d melted, avg alpha %.3f, max %.1f W, %llu dropped"),
+		Window.NumObjects, Window.NumRecords, Window.NumMelted, Window.AvgMeltAlpha, Window.MaxPowerW, Window.NumDropped));
+}
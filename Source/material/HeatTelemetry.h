@@ -0,0 +1,103 @@
+// HeatTelemetry.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/CriticalSection.h"
+
+#include <atomic>
+
+class FRunnableThread;
+class FEvent;
+
+/** One melt sample of one block */
+struct FHeatTelemetryRecord
+{
+	/** Seconds since start, filled in by Record */
+	double Time = 0.0;
+	uint32 ObjectId = 0;
+	float DistCm = 0.0f;
+	float PowerW = 0.0f;
+	float EnergyJ = 0.0f;
+	float MeltAlpha = 0.0f;
+	float Scale = 1.0f;
+};
+
+/** Totals of the last drained window, for the on-screen summary */
+struct FHeatTelemetrySummary
+{
+	int32 NumRecords = 0;
+	int32 NumObjects = 0;
+	int32 NumMelted = 0;
+	float MaxPowerW = 0.0f;
+	float AvgMeltAlpha = 0.0f;
+	uint64 NumDropped = 0;
+};
+
+/**
+ *  Fixed-size, lock-free ring of melt records that any thread can append to without allocating.
+ *  A low priority thread drains it every heat.Telemetry.Interval seconds into Saved/Telemetry (heat.Telemetry.Dump:
+ *  1 = CSV, 2 = binary) and aggregates it for the on-screen summary (heat.Telemetry.Summary).
+ *  Records the dumper has not reached before the ring wraps are dropped and counted.
+ */
+class MATERIAL_API FHeatTelemetry : public FRunnable
+{
+public:
+
+	static FHeatTelemetry& Get();
+
+	/** Appends a record, stamping its time. Safe from any thread */
+	void Record(const FHeatTelemetryRecord& InRecord);
+
+	/** Posts the aggregate of the last window as one on-screen line, if heat.Telemetry.Summary is set */
+	void DrawSummary() const;
+
+	FHeatTelemetrySummary GetSummary() const;
+
+#if !UE_BUILD_SHIPPING
+	/** heat.Telemetry.BlockText: the old per-block on-screen strings, for eyeballing a single block */
+	static bool ShowBlockText();
+#endif
+
+	// ~begin FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// ~end FRunnable interface
+
+private:
+
+	FHeatTelemetry();
+	virtual ~FHeatTelemetry() override;
+
+	void Shutdown();
+	void Drain();
+	void WriteRecords(TConstArrayView<FHeatTelemetryRecord> Records);
+	void CloseDump();
+
+	static constexpr uint64 Capacity = 1 << 14;
+
+	/** Sequence is index + 1 once the record at that index is fully written, 0 while a producer writes */
+	struct FSlot
+	{
+		std::atomic<uint64> Sequence { 0 };
+		FHeatTelemetryRecord Record;
+	};
+
+	TUniquePtr<FSlot[]> Slots;
+	std::atomic<uint64> WriteCursor { 0 };
+	std::atomic<uint64> NumDropped { 0 };
+	std::atomic<bool> bStopping { false };
+
+	/** Dumper thread only */
+	uint64 ReadCursor = 0;
+	TArray<FHeatTelemetryRecord> Scratch;
+	TUniquePtr<FArchive> DumpFile;
+	int32 DumpMode = 0;
+
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeEvent = nullptr;
+
+	mutable FCriticalSection SummaryLock;
+	FHeatTelemetrySummary Summary;
+};
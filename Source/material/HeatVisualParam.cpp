@@ -0,0 +1,26 @@
+// HeatVisualParam.cpp
+
+#include "HeatVisualParam.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+bool FHeatVisualParam::Set(UPrimitiveComponent* Component, UMaterialInstanceDynamic* MID, bool bUseCPD, FName ParamName, int32 CPDIndex, float Value)
+{
+	if (bValid && LastValue == Value) return false;
+
+	if (bUseCPD)
+	{
+		if (!Component || CPDIndex < 0) return false;
+		Component->SetCustomPrimitiveDataFloat(CPDIndex, Value);
+	}
+	else
+	{
+		if (!MID) return false;
+		MID->SetScalarParameterValue(ParamName, Value);
+	}
+
+	LastValue = Value;
+	bValid = true;
+	return true;
+}
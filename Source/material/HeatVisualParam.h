@@ -0,0 +1,25 @@
+// HeatVisualParam.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPrimitiveComponent;
+class UMaterialInstanceDynamic;
+
+/**
+ *  Scalar visual parameter written either to a MID or to custom primitive data, only when its value changes.
+ *  Custom primitive data keeps identical meshes on one shared material, so they can batch together.
+ */
+struct FHeatVisualParam
+{
+	/** Writes the value to the CPD slot when bUseCPD is set, otherwise to the MID parameter. Returns true if anything was pushed */
+	bool Set(UPrimitiveComponent* Component, UMaterialInstanceDynamic* MID, bool bUseCPD, FName ParamName, int32 CPDIndex, float Value);
+
+	/** Forces the next Set to push, e.g. after the MID was replaced */
+	void Invalidate() { bValid = false; }
+
+private:
+	float LastValue = 0.0f;
+	bool bValid = false;
+};
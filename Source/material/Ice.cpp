@@ -7,10 +7,14 @@
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Engine/Engine.h"
 #include "Temperature.h"
+#include "HeatSimSubsystem.h"
+#include "HeatPhaseSubsystem.h"
+#include "HeatTelemetry.h"
+#include "ThermalMeshData.h"
 
 AIce::AIce()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	MeshComp = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("MeshComp"));
 	SetRootComponent(MeshComp);
@@ -42,114 +46,210 @@ void AIce::BeginPlay()
 
 		if (IceMeltMaterial)
 		{
-			IceMI = UMaterialInstanceDynamic::Create(IceMeltMaterial, this);
-			MeshComp->SetMaterial(0, IceMI);
+			if (bUseCPD)
+			{
+				MeshComp->SetMaterial(0, IceMeltMaterial);
+			}
+			else
+			{
+				IceMI = UMaterialInstanceDynamic::Create(IceMeltMaterial, this);
+				MeshComp->SetMaterial(0, IceMI);
+			}
+			InvalidateMeltParams();
 		}
 
 		ApplyMeltVisual(MeltAlpha);
+		SyncHeatReceiver();
 	}
 }
 
-void AIce::Tick(float DeltaTime)
+void AIce::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	UnregisterHeatReceiver();
 
-	if (!bHeating || !CurrentFire || MeltAlpha >= 1.0f || !MeshComp)
-	{
-		return;
-	}
-
-	const float DistCm = FVector::Dist(CurrentFire->GetActorLocation(), GetActorLocation());
-
-	if (CurrentFire->MaxHeatDistance > 0.0f && DistCm > CurrentFire->MaxHeatDistance)
-	{
-    return;
-	}
-
-	const float DistM = FMath::Max(DistCm / 100.0f, 0.05f);
-
-	const float PtotalW = CurrentFire->GetTotalRadiantPowerW();
-	float HeatFluxWm2 = PtotalW / (4.0f * PI * DistM * DistM);
-
-	float ReceivedPowerW = HeatFluxWm2 * EffectiveAreaM2;
-
-	if (CurrentFire->MaxHeatDistance > 0.0f)
-	{
-    const float Fade = FMath::Clamp(1.0f - (DistCm / CurrentFire->MaxHeatDistance), 0.0f, 1.0f);
-    ReceivedPowerW *= Fade;
-	}
+	Super::EndPlay(EndPlayReason);
+}
 
-	if (ReceivedPowerW <= 0.0f)
-	{
-		return;
-	}
+void AIce::ApplyHeatSimState(float NewEnergyJ, float NewMeltAlpha, float ReceivedPowerW, float DistCm, float DeltaTime)
+{
+	if (!MeshComp) return;
 
-	EnergyAccumJ += ReceivedPowerW * DeltaTime * FMath::Max(SimTimeScale, 0.0f);
-	MeltAlpha = FMath::Clamp(EnergyAccumJ / FMath::Max(TotalMeltEnergyJ, 1.0f), 0.0f, 1.0f);
+	EnergyAccumJ = NewEnergyJ;
+	MeltAlpha = NewMeltAlpha;
 
 	ApplyMeltVisual(MeltAlpha);
 
-	if (bDebugMelt && GEngine)
+	if (bDebugMelt)
 	{
 		DebugAcc += DeltaTime;
 		if (DebugAcc >= 0.25f)
 		{
 			DebugAcc = 0.0f;
 			const FVector S = GetActorScale3D();
-			const uint64 Key = (uint64)GetUniqueID();
-
+			FHeatTelemetry::Get().Record({ 0.0, GetUniqueID(), DistCm, ReceivedPowerW, EnergyAccumJ, MeltAlpha, static_cast<float>(S.X) });
 		}
 	}
 
+	DepositMeltWater();
+
 	if (MeltAlpha >= 1.0f)
 	{
 		if (bDestroyMeshWhenMelted)
 		{
-			MeshComp->DestroyComponent();
-			MeshComp = nullptr;
+			UActorPoolSubsystem::ReleaseOrDestroy(this);
 		}
 	}
 }
 
-void AIce::StartHeating(ATemperature* FireRef)
+void AIce::ResetMelt(float NewEnergyJ, float NewMeltAlpha)
+{
+	if (!MeshComp) return;
+
+	if (MeltAlpha > 0.0f)
+	{
+		MeshComp->SetWorldScale3D(InitialScale);
+	}
+	InitialScale = MeshComp->GetComponentScale();
+	RecalcMassAndEnergy();
+
+	EnergyAccumJ = NewEnergyJ;
+	MeltAlpha = NewMeltAlpha;
+	DepositedMeltAlpha = 0.0f;
+	AppliedScaleFactor = -1.0f;
+	DebugAcc = 0.0f;
+
+	InvalidateMeltParams();
+	ApplyMeltVisual(MeltAlpha);
+	SyncHeatReceiver(true);
+}
+
+void AIce::RestoreMelt(const FVector& UnmeltedScale, float NewEnergyJ, float NewMeltAlpha)
+{
+	if (!MeshComp) return;
+
+	// ResetMelt takes the unmelted size from the component
+	MeshComp->SetWorldScale3D(UnmeltedScale);
+	MeltAlpha = 0.0f;
+
+	ResetMelt(NewEnergyJ, NewMeltAlpha);
+	DepositedMeltAlpha = MeltAlpha;
+}
+
+void AIce::ApplyReplicatedMelt(float NewMeltAlpha)
 {
-	CurrentFire = FireRef;
-	bHeating = (CurrentFire != nullptr);
+	if (!MeshComp) return;
 
-	if (bDebugMelt && GEngine)
+	// the sim slot is corrected before the state is applied, which may release the block. The server's
+	// state replaces a local analytic prediction. A block about to be released is not registered again
+	EnergyAccumJ = NewMeltAlpha * TotalMeltEnergyJ;
+	MeltAlpha = NewMeltAlpha;
+	if (MeltAlpha < 1.0f || !bDestroyMeshWhenMelted)
 	{
-    const uint64 Key = (uint64)GetUniqueID();
-	GEngine->AddOnScreenDebugMessage(Key + 1ULL, 1.0f, FColor::Green, TEXT("StartHeating OK"));
+		SyncHeatReceiver(true);
 	}
 
+	ApplyHeatSimState(EnergyAccumJ, MeltAlpha, 0.0f, 0.0f, 0.0f);
+}
+
+void AIce::OnAcquiredFromPool()
+{
+	ResetMelt();
 }
 
-void AIce::StopHeating()
+void AIce::OnReturnedToPool()
 {
+	UnregisterHeatReceiver();
+	HeatingFires.Reset();
 	bHeating = false;
-	CurrentFire = nullptr;
+
+	// the acquire transform sets the next size, not the melted one
+	MeltAlpha = 0.0f;
 }
 
-void AIce::RecalcMassAndEnergy()
+void AIce::BeginMeltTimeline(float StartAlpha, float StartTime, float EndTime)
+{
+	MeltStartAlphaParam.Set(MeshComp, IceMI, bUseCPD, MeltStartAlphaParamName, CPDIndex_MeltTimeline, StartAlpha);
+	MeltStartTimeParam.Set(MeshComp, IceMI, bUseCPD, MeltStartTimeParamName, CPDIndex_MeltTimeline + 1, StartTime);
+	MeltEndTimeParam.Set(MeshComp, IceMI, bUseCPD, MeltEndTimeParamName, CPDIndex_MeltTimeline + 2, EndTime);
+}
+
+void AIce::EndMeltTimeline()
 {
-	if (!MeshComp)
+	MeltStartTimeParam.Set(MeshComp, IceMI, bUseCPD, MeltStartTimeParamName, CPDIndex_MeltTimeline + 1, 0.0f);
+	MeltEndTimeParam.Set(MeshComp, IceMI, bUseCPD, MeltEndTimeParamName, CPDIndex_MeltTimeline + 2, 0.0f);
+}
+
+void AIce::StartHeating_Implementation(ATemperature* FireRef)
+{
+	if (!FireRef) return;
+
+	HeatingFires.AddUnique(FireRef);
+	bHeating = true;
+
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->AddReceiverSource(this, FireRef);
+	}
+
+#if !UE_BUILD_SHIPPING
+	if (bDebugMelt && FHeatTelemetry::ShowBlockText())
+	{
+		const uint64 Key = (uint64)GetUniqueID();
+		GEngine->AddOnScreenDebugMessage(Key + 1ULL, 1.0f, FColor::Green, TEXT("StartHeating OK"));
+	}
+#endif
+}
+
+void AIce::StopHeating_Implementation(ATemperature* FireRef)
+{
+	HeatingFires.RemoveSingleSwap(FireRef);
+	bHeating = HeatingFires.Num() > 0;
+
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
 	{
-		VolumeM3 = 1.0f;
-		EffectiveAreaM2 = 1.0f;
-		TotalMeltEnergyJ = IceDensityKgM3 * VolumeM3 * LatentHeatJPerKg;
-		return;
+		HeatSim->RemoveReceiverSource(this, FireRef);
 	}
+}
 
-	const FBoxSphereBounds B = MeshComp->Bounds;
-	const FVector SizeCm = B.BoxExtent * 2.0f;
-	const FVector SizeM = SizeCm / 100.0f;
+bool AIce::IsHeating_Implementation() const
+{
+	return bHeating;
+}
+
+bool AIce::GetHeatReceiverBody(FHeatReceiverBody& OutBody, float& OutEnergyAccumJ) const
+{
+	if (!MeshComp) return false;
+
+	OutBody.VolumeM3 = VolumeM3;
+	OutBody.EffectiveAreaM2 = EffectiveAreaM2;
+	OutBody.TotalMeltEnergyJ = TotalMeltEnergyJ;
+	OutBody.SimTimeScale = SimTimeScale;
+	OutBody.bCanMelt = true;
+	OutEnergyAccumJ = EnergyAccumJ;
+	return true;
+}
+
+void AIce::SyncHeatReceiver(bool bAuthoritativeEnergy)
+{
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->RegisterReceiver(this, bAuthoritativeEnergy);
+	}
+}
 
-	VolumeM3 = FMath::Max(SizeM.X * SizeM.Y * SizeM.Z, 1e-6f);
+void AIce::UnregisterHeatReceiver()
+{
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->UnregisterReceiver(this);
+	}
+}
 
-	const float Axy = SizeM.X * SizeM.Y;
-	const float Axz = SizeM.X * SizeM.Z;
-	const float Ayz = SizeM.Y * SizeM.Z;
-	EffectiveAreaM2 = FMath::Max3(Axy, Axz, Ayz);
+void AIce::RecalcMassAndEnergy()
+{
+	const UStaticMesh* Mesh = MeshComp ? MeshComp->GetStaticMesh() : nullptr;
+	const FVector Scale = MeshComp ? MeshComp->GetComponentScale() : FVector::OneVector;
+	UThermalMeshData::GetScaledBody(Mesh, Scale, VolumeM3, EffectiveAreaM2);
 
 	const float MassKg = IceDensityKgM3 * VolumeM3;
 	TotalMeltEnergyJ = FMath::Max(MassKg * LatentHeatJPerKg, 1.0f);
@@ -162,13 +262,46 @@ void AIce::ApplyMeltVisual(float Alpha01)
 	const float A = FMath::Clamp(Alpha01, 0.0f, 1.0f);
 
 	const float Ratio = FMath::Clamp(MinScaleRatio, 0.0f, 1.0f);
-	const FVector TargetScale = InitialScale * Ratio;
-	const FVector NewScale = FMath::Lerp(InitialScale, TargetScale, A);
+	const float TargetFactor = FMath::Lerp(1.0f, Ratio, A);
+
+	// the transform only follows in coarse steps, the material shrinks the rest of the way
+	float ScaleFactor = TargetFactor;
+	if (bShrinkInMaterial && (IceMI || bUseCPD))
+	{
+		const float Step = FMath::Clamp(ScaleSnapStep, 0.01f, 1.0f);
+		const float SnappedAlpha = A >= 1.0f ? 1.0f : FMath::FloorToFloat(A / Step) * Step;
+		ScaleFactor = FMath::Lerp(1.0f, Ratio, SnappedAlpha);
+	}
+
+	if (ScaleFactor != AppliedScaleFactor)
+	{
+		MeshComp->SetWorldScale3D(InitialScale * ScaleFactor);
+		AppliedScaleFactor = ScaleFactor;
+	}
 
-	MeshComp->SetWorldScale3D(NewScale);
+	MeltAlphaParam.Set(MeshComp, IceMI, bUseCPD, MeltParamName, CPDIndex_MeltAlpha, A);
+	MeltShrinkParam.Set(MeshComp, IceMI, bUseCPD, MeltShrinkParamName, CPDIndex_MeltShrink, ScaleFactor > 0.0f ? TargetFactor / ScaleFactor : 1.0f);
+}
 
-	if (IceMI)
+void AIce::DepositMeltWater()
+{
+	// the water leaves in the same coarse steps as the transform, and the rest once fully melted
+	const float Melted = MeltAlpha - DepositedMeltAlpha;
+	if (Melted <= 0.0f || (MeltAlpha < 1.0f && Melted < FMath::Clamp(ScaleSnapStep, 0.01f, 1.0f))) return;
+
+	DepositedMeltAlpha = MeltAlpha;
+
+	if (UHeatPhaseSubsystem* Phase = GetWorld()->GetSubsystem<UHeatPhaseSubsystem>())
 	{
-		IceMI->SetScalarParameterValue(MeltParamName, A);
+		Phase->DepositMeltWater(this, GetActorLocation(), UHeatPhaseSubsystem::IceToWaterVolumeM3(VolumeM3 * Melted, IceDensityKgM3));
 	}
 }
+
+void AIce::InvalidateMeltParams()
+{
+	MeltAlphaParam.Invalidate();
+	MeltShrinkParam.Invalidate();
+	MeltStartAlphaParam.Invalidate();
+	MeltStartTimeParam.Invalidate();
+	MeltEndTimeParam.Invalidate();
+}
@@ -4,6 +4,9 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "HeatReceiver.h"
+#include "HeatVisualParam.h"
+#include "ActorPoolSubsystem.h"
 #include "Ice.generated.h"
 
 class UStaticMeshComponent;
@@ -12,7 +15,7 @@ class UMaterialInstanceDynamic;
 class ATemperature;
 
 UCLASS()
-class MATERIAL_API AIce : public AActor
+class MATERIAL_API AIce : public AActor, public IHeatReceiver, public IPooledActor
 {
 	GENERATED_BODY()
 
@@ -21,15 +24,34 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void OnConstruction(const FTransform& Transform) override;
 
 public:
+	// ~begin IHeatReceiver interface
+	virtual void StartHeating_Implementation(ATemperature* FireRef) override;
+	virtual void StopHeating_Implementation(ATemperature* FireRef) override;
+	virtual bool IsHeating_Implementation() const override;
+	virtual bool GetHeatReceiverBody(FHeatReceiverBody& OutBody, float& OutEnergyAccumJ) const override;
+	virtual void ApplyHeatSimState(float NewEnergyJ, float NewMeltAlpha, float ReceivedPowerW, float DistCm, float DeltaTime) override;
+	virtual void BeginMeltTimeline(float StartAlpha, float StartTime, float EndTime) override;
+	virtual void EndMeltTimeline() override;
+	// ~end IHeatReceiver interface
+
+	// ~begin IPooledActor interface
+	virtual void OnAcquiredFromPool() override;
+	virtual void OnReturnedToPool() override;
+	// ~end IPooledActor interface
+
+	/** Restarts the melt from the unmelted size at the given state, e.g. after a puzzle reset or when promoted from an AIceField */
 	UFUNCTION(BlueprintCallable, Category="Ice")
-	void StartHeating(ATemperature* FireRef);
+	void ResetMelt(float NewEnergyJ = 0.0f, float NewMeltAlpha = 0.0f);
 
-	UFUNCTION(BlueprintCallable, Category="Ice")
-	void StopHeating();
+	/** Puts back a melt state saved by UHeatSnapshotSubsystem. Its melt water is treated as already deposited */
+	void RestoreMelt(const FVector& UnmeltedScale, float NewEnergyJ, float NewMeltAlpha);
+
+	/** Takes the server's melt alpha on a client. The local sim carries on predicting from it */
+	void ApplyReplicatedMelt(float NewMeltAlpha);
 
 public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Ice|Components")
@@ -41,9 +63,49 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
 	FName MeltParamName = TEXT("MeltAlpha");
 
+	/** Analytic melt timeline. While MeltEndTime > MeltStartTime the material lerps from MeltStartAlpha to 1 over that window of Time */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	FName MeltStartTimeParamName = TEXT("MeltStartTime");
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	FName MeltEndTimeParamName = TEXT("MeltEndTime");
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	FName MeltStartAlphaParamName = TEXT("MeltStartAlpha");
+
+	/** Pushes the melt parameters through custom primitive data on the shared IceMeltMaterial instead of a per-actor MID */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	bool bUseCPD = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual", meta=(EditCondition="bUseCPD"))
+	int32 CPDIndex_MeltAlpha = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual", meta=(EditCondition="bUseCPD"))
+	int32 CPDIndex_MeltShrink = 1;
+
+	/** First of three consecutive slots: timeline start alpha, start time, end time */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual", meta=(EditCondition="bUseCPD"))
+	int32 CPDIndex_MeltTimeline = 2;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Melt")
 	float MinScaleRatio = 0.15f;
 
+	/**
+	 *  Shrinks the mesh in the material (World Position Offset driven by MeltShrinkParamName) between coarse transform updates.
+	 *  Only for materials that read MeltShrink, otherwise the block visibly jumps from one ScaleSnapStep to the next
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Melt")
+	bool bShrinkInMaterial = false;
+
+	/** Melt alpha step at which the component scale, bounds and collision are updated when bShrinkInMaterial is set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Melt", meta=(ClampMin=0.01, ClampMax=1.0, EditCondition="bShrinkInMaterial"))
+	float ScaleSnapStep = 0.25f;
+
+	/** Scale factor relative to the current component scale, 1 = no extra shrink. The material scales around the object pivot */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	FName MeltShrinkParamName = TEXT("MeltShrink");
+
+	/** Returns the block to the actor pool once fully melted */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Melt")
 	bool bDestroyMeshWhenMelted = true;
 
@@ -72,7 +134,7 @@ public:
 	FVector InitialScale = FVector(1.0f);
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Ice|State")
-	ATemperature* CurrentFire = nullptr;
+	TArray<ATemperature*> HeatingFires;
 
 private:
 	UPROPERTY(Transient)
@@ -83,6 +145,24 @@ private:
 	float TotalMeltEnergyJ = 1.0f;
 	float DebugAcc = 0.0f;
 
+	/** Melt alpha whose water has already been handed to UHeatPhaseSubsystem */
+	float DepositedMeltAlpha = 0.0f;
+
+	/** Scale factor last written to the component transform, negative until the first write */
+	float AppliedScaleFactor = -1.0f;
+
+	FHeatVisualParam MeltAlphaParam;
+	FHeatVisualParam MeltShrinkParam;
+	FHeatVisualParam MeltStartAlphaParam;
+	FHeatVisualParam MeltStartTimeParam;
+	FHeatVisualParam MeltEndTimeParam;
+
+	void InvalidateMeltParams();
+
 	void RecalcMassAndEnergy();
+	/** Pushes the body to the heat sim. bAuthoritativeEnergy makes EnergyAccumJ replace a running analytic prediction */
+	void SyncHeatReceiver(bool bAuthoritativeEnergy = false);
+	void UnregisterHeatReceiver();
 	void ApplyMeltVisual(float Alpha01);
+	void DepositMeltWater();
 };
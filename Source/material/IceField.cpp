@@ -0,0 +1,311 @@
+// IceField.cpp
+
+#include "IceField.h"
+
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "TimerManager.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Ice.h"
+#include "HeatPhaseSubsystem.h"
+#include "ThermalMeshData.h"
+
+AIceField::AIceField()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Blocks = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Blocks"));
+	SetRootComponent(Blocks);
+
+	Blocks->SetCollisionProfileName(TEXT("BlockAllDynamic"));
+	Blocks->NumCustomDataFloats = 5;
+
+	// melted blocks are removed by swapping the last instance in, BlockSlots mirrors that
+	Blocks->bSupportRemoveAtSwap = true;
+}
+
+void AIceField::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const int32 NeededFloats = FMath::Max3(CustomDataIndex_MeltAlpha, CustomDataIndex_MeltShrink, CustomDataIndex_MeltTimeline + 2) + 1;
+	if (Blocks->NumCustomDataFloats < NeededFloats)
+	{
+		Blocks->SetNumCustomDataFloats(NeededFloats);
+	}
+
+	RegisterBlocks();
+	MoveHandle = Blocks->TransformUpdated.AddUObject(this, &AIceField::OnFieldMoved);
+
+	if (bSimulateAsMass && PromoteRadius > 0.0f)
+	{
+		GetWorldTimerManager().SetTimer(PromoteTimer, this, &AIceField::PromoteNearPlayers, PromoteCheckInterval, true);
+	}
+}
+
+void AIceField::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Blocks->TransformUpdated.Remove(MoveHandle);
+	UnregisterBlocks();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AIceField::RegisterBlocks()
+{
+	UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>();
+	if (!HeatSim) return;
+
+	const int32 NumInstances = Blocks->GetInstanceCount();
+	BlockReceiverIds.Reset(NumInstances);
+	BlockEntities.Reset(NumInstances);
+	BlockEnergyJ.Reset(NumInstances);
+	BlockAlpha.Reset(NumInstances);
+	BlockBaseTransforms.Reset(NumInstances);
+	BlockAppliedScale.Reset(NumInstances);
+
+	for (int32 i = 0; i < NumInstances; ++i)
+	{
+		FTransform LocalTransform;
+		FTransform WorldTransform;
+		Blocks->GetInstanceTransform(i, LocalTransform, false);
+		Blocks->GetInstanceTransform(i, WorldTransform, true);
+
+		const int32 Key = BlockSlots.Add();
+		const FHeatReceiverBody Body = MakeBlockBody(WorldTransform);
+
+		if (bSimulateAsMass)
+		{
+			BlockEntities.Add(HeatSim->CreateMassReceiver(this, this, Key, WorldTransform.GetLocation(), Body, 0.0f));
+			BlockReceiverIds.Add(INDEX_NONE);
+		}
+		else
+		{
+			BlockEntities.AddDefaulted();
+			BlockReceiverIds.Add(HeatSim->RegisterReceiverInstance(this, this, Key, WorldTransform.GetLocation(), Body, 0.0f));
+		}
+		BlockEnergyJ.Add(0.0f);
+		BlockAlpha.Add(0.0f);
+		BlockBaseTransforms.Add(LocalTransform);
+		BlockAppliedScale.Add(1.0f);
+
+		ApplyBlockVisual(i, 0.0f);
+	}
+}
+
+void AIceField::UnregisterBlocks()
+{
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		for (const int32 ReceiverId : BlockReceiverIds)
+		{
+			HeatSim->UnregisterReceiverInstance(ReceiverId);
+		}
+		for (const FMassEntityHandle Entity : BlockEntities)
+		{
+			HeatSim->DestroyMassReceiver(Entity);
+		}
+	}
+
+	BlockSlots = FHeatSlotMap();
+	BlockReceiverIds.Reset();
+	BlockEntities.Reset();
+	BlockEnergyJ.Reset();
+	BlockAlpha.Reset();
+	BlockBaseTransforms.Reset();
+	BlockAppliedScale.Reset();
+}
+
+void AIceField::RemoveBlock(int32 InstanceKey)
+{
+	const int32 Index = BlockSlots.GetIndex(InstanceKey);
+	if (Index == INDEX_NONE) return;
+
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->UnregisterReceiverInstance(BlockReceiverIds[Index]);
+		HeatSim->DestroyMassReceiver(BlockEntities[Index]);
+	}
+
+	Blocks->RemoveInstance(Index);
+
+	int32 RemovedIndex;
+	BlockSlots.RemoveAtSwap(InstanceKey, RemovedIndex);
+	BlockReceiverIds.RemoveAtSwap(RemovedIndex, EAllowShrinking::No);
+	BlockEntities.RemoveAtSwap(RemovedIndex, EAllowShrinking::No);
+	BlockEnergyJ.RemoveAtSwap(RemovedIndex, EAllowShrinking::No);
+	BlockAlpha.RemoveAtSwap(RemovedIndex, EAllowShrinking::No);
+	BlockBaseTransforms.RemoveAtSwap(RemovedIndex, EAllowShrinking::No);
+	BlockAppliedScale.RemoveAtSwap(RemovedIndex, EAllowShrinking::No);
+}
+
+FHeatReceiverBody AIceField::MakeBlockBody(const FTransform& WorldTransform) const
+{
+	FHeatReceiverBody Body;
+	Body.SimTimeScale = SimTimeScale;
+	Body.bCanMelt = true;
+
+	// same body as an AIce of this mesh at the instance's scale
+	UThermalMeshData::GetScaledBody(Blocks->GetStaticMesh(), WorldTransform.GetScale3D(), Body.VolumeM3, Body.EffectiveAreaM2);
+
+	Body.TotalMeltEnergyJ = FMath::Max(IceDensityKgM3 * Body.VolumeM3 * LatentHeatJPerKg, 1.0f);
+	return Body;
+}
+
+void AIceField::ApplyInstanceHeatSimState(int32 InstanceKey, float NewEnergyJ, float NewMeltAlpha, float ReceivedPowerW, float DistCm, float DeltaTime)
+{
+	const int32 Index = BlockSlots.GetIndex(InstanceKey);
+	if (Index == INDEX_NONE) return;
+
+	const bool bJustMelted = NewMeltAlpha >= 1.0f && BlockAlpha[Index] < 1.0f;
+
+	BlockEnergyJ[Index] = NewEnergyJ;
+	BlockAlpha[Index] = NewMeltAlpha;
+
+	ApplyBlockVisual(Index, NewMeltAlpha);
+
+	// blocks are small, their water goes down in one go once fully melted
+	if (bJustMelted)
+	{
+		if (UHeatPhaseSubsystem* Phase = GetWorld()->GetSubsystem<UHeatPhaseSubsystem>())
+		{
+			const FTransform WorldTransform = BlockBaseTransforms[Index] * Blocks->GetComponentTransform();
+			const float IceVolumeM3 = MakeBlockBody(WorldTransform).VolumeM3;
+			Phase->DepositMeltWater(this, WorldTransform.GetLocation(), UHeatPhaseSubsystem::IceToWaterVolumeM3(IceVolumeM3, IceDensityKgM3));
+		}
+	}
+
+	if (NewMeltAlpha >= 1.0f && bRemoveMeltedBlocks)
+	{
+		RemoveBlock(InstanceKey);
+	}
+}
+
+void AIceField::BeginInstanceMeltTimeline(int32 InstanceKey, float StartAlpha, float StartTime, float EndTime)
+{
+	const int32 Index = BlockSlots.GetIndex(InstanceKey);
+	if (Index == INDEX_NONE) return;
+
+	SetBlockCustomData(Index, CustomDataIndex_MeltTimeline, StartAlpha);
+	SetBlockCustomData(Index, CustomDataIndex_MeltTimeline + 1, StartTime);
+	SetBlockCustomData(Index, CustomDataIndex_MeltTimeline + 2, EndTime);
+}
+
+void AIceField::EndInstanceMeltTimeline(int32 InstanceKey)
+{
+	const int32 Index = BlockSlots.GetIndex(InstanceKey);
+	if (Index == INDEX_NONE) return;
+
+	SetBlockCustomData(Index, CustomDataIndex_MeltTimeline + 1, 0.0f);
+	SetBlockCustomData(Index, CustomDataIndex_MeltTimeline + 2, 0.0f);
+}
+
+float AIceField::GetBlockMeltAlpha(int32 InstanceIndex) const
+{
+	return BlockAlpha.IsValidIndex(InstanceIndex) ? BlockAlpha[InstanceIndex] : 0.0f;
+}
+
+AIce* AIceField::PromoteBlock(int32 InstanceIndex)
+{
+	if (!BlockAlpha.IsValidIndex(InstanceIndex)) return nullptr;
+
+	// spawned at the unmelted size, the actor scales itself down from its own melt alpha
+	const FTransform SpawnTransform = BlockBaseTransforms[InstanceIndex] * Blocks->GetComponentTransform();
+
+	// the Mass state can be a frame ahead of the last applied one, the alpha is derived from the same energy
+	float EnergyJ = BlockEnergyJ[InstanceIndex];
+	float Alpha = BlockAlpha[InstanceIndex];
+	UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>();
+	if (HeatSim && BlockEntities[InstanceIndex].IsSet())
+	{
+		EnergyJ = HeatSim->GetMassReceiverEnergyJ(BlockEntities[InstanceIndex]);
+		Alpha = FMath::Clamp(EnergyJ / FMath::Max(MakeBlockBody(SpawnTransform).TotalMeltEnergyJ, 1.0f), 0.0f, 1.0f);
+	}
+
+	UClass* SpawnClass = PromotedActorClass ? PromotedActorClass.Get() : AIce::StaticClass();
+
+	UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+	AIce* Ice = Pool ? Cast<AIce>(Pool->Acquire(SpawnClass, SpawnTransform)) : nullptr;
+	if (!Ice) return nullptr;
+
+	if (Ice->MeshComp && !Ice->MeshComp->GetStaticMesh())
+	{
+		Ice->MeshComp->SetStaticMesh(Blocks->GetStaticMesh());
+	}
+	Ice->ResetMelt(EnergyJ, Alpha);
+
+	RemoveBlock(BlockSlots.IndexToId[InstanceIndex]);
+	return Ice;
+}
+
+void AIceField::PromoteNearPlayers()
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+		const APawn* Pawn = PC ? PC->GetPawn() : nullptr;
+		if (!Pawn) continue;
+
+		TArray<int32> Overlapping = Blocks->GetInstancesOverlappingSphere(Pawn->GetActorLocation(), PromoteRadius, true);
+
+		// highest index first, remove-at-swap then only moves instances that are not in the list
+		Overlapping.Sort(TGreater<int32>());
+		for (const int32 InstanceIndex : Overlapping)
+		{
+			PromoteBlock(InstanceIndex);
+		}
+	}
+}
+
+void AIceField::ApplyBlockVisual(int32 InstanceIndex, float Alpha01)
+{
+	const float A = FMath::Clamp(Alpha01, 0.0f, 1.0f);
+
+	const float Ratio = FMath::Clamp(MinScaleRatio, 0.0f, 1.0f);
+	const float TargetFactor = FMath::Lerp(1.0f, Ratio, A);
+
+	// rebuilding an instance body is the expensive part, so the transform only follows in coarse steps
+	const float Step = FMath::Clamp(ScaleSnapStep, 0.01f, 1.0f);
+	const float SnappedAlpha = A >= 1.0f ? 1.0f : FMath::FloorToFloat(A / Step) * Step;
+	const float ScaleFactor = FMath::Lerp(1.0f, Ratio, SnappedAlpha);
+
+	if (ScaleFactor != BlockAppliedScale[InstanceIndex])
+	{
+		FTransform Transform = BlockBaseTransforms[InstanceIndex];
+		Transform.SetScale3D(Transform.GetScale3D() * ScaleFactor);
+
+		Blocks->UpdateInstanceTransform(InstanceIndex, Transform, false, true, true);
+		BlockAppliedScale[InstanceIndex] = ScaleFactor;
+	}
+
+	SetBlockCustomData(InstanceIndex, CustomDataIndex_MeltAlpha, A);
+	SetBlockCustomData(InstanceIndex, CustomDataIndex_MeltShrink, ScaleFactor > 0.0f ? TargetFactor / ScaleFactor : 1.0f);
+}
+
+void AIceField::SetBlockCustomData(int32 InstanceIndex, int32 DataIndex, float Value)
+{
+	const int32 NumFloats = Blocks->NumCustomDataFloats;
+	if (DataIndex < 0 || DataIndex >= NumFloats) return;
+
+	const int32 Offset = InstanceIndex * NumFloats + DataIndex;
+	if (Blocks->PerInstanceSMCustomData.IsValidIndex(Offset) && Blocks->PerInstanceSMCustomData[Offset] == Value) return;
+
+	// only this instance is sent to the render thread, not the whole component
+	Blocks->SetCustomDataValue(InstanceIndex, DataIndex, Value, true);
+}
+
+void AIceField::OnFieldMoved(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport)
+{
+	UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>();
+	if (!HeatSim) return;
+
+	for (int32 i = 0; i < BlockReceiverIds.Num(); ++i)
+	{
+		FTransform WorldTransform;
+		Blocks->GetInstanceTransform(i, WorldTransform, true);
+		HeatSim->MoveReceiverInstance(BlockReceiverIds[i], WorldTransform.GetLocation());
+		HeatSim->MoveMassReceiver(BlockEntities[i], WorldTransform.GetLocation());
+	}
+}
@@ -0,0 +1,128 @@
+// IceField.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "HeatReceiver.h"
+#include "HeatSimSubsystem.h"
+#include "IceField.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+class AIce;
+
+/**
+ *  Many ice blocks stored as instances of one HISM, each melting with the same physics as AIce.
+ *  Every instance is its own heat receiver in UHeatSimSubsystem, so there is no actor, tick or MID per block.
+ *  Melt state is written to per-instance custom data: the material reads MeltAlpha, MeltShrink and the analytic
+ *  timeline (start alpha, start time, end time) through PerInstanceCustomData at the indices below.
+ *  With bSimulateAsMass the blocks are Mass entities instead, and only become AIce actors once a player comes close.
+ */
+UCLASS()
+class MATERIAL_API AIceField : public AActor, public IHeatInstancedReceiver
+{
+	GENERATED_BODY()
+
+public:
+	AIceField();
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	// ~begin IHeatInstancedReceiver interface
+	virtual void ApplyInstanceHeatSimState(int32 InstanceKey, float NewEnergyJ, float NewMeltAlpha, float ReceivedPowerW, float DistCm, float DeltaTime) override;
+	virtual void BeginInstanceMeltTimeline(int32 InstanceKey, float StartAlpha, float StartTime, float EndTime) override;
+	virtual void EndInstanceMeltTimeline(int32 InstanceKey) override;
+	// ~end IHeatInstancedReceiver interface
+
+	/** Number of blocks that have not melted away */
+	UFUNCTION(BlueprintPure, Category="Ice")
+	int32 GetNumBlocks() const { return BlockSlots.Num(); }
+
+	/** Melt alpha of the block at the given instance index */
+	UFUNCTION(BlueprintPure, Category="Ice")
+	float GetBlockMeltAlpha(int32 InstanceIndex) const;
+
+	/** Replaces the block with a PromotedActorClass actor carrying over its melt energy */
+	UFUNCTION(BlueprintCallable, Category="Ice")
+	AIce* PromoteBlock(int32 InstanceIndex);
+
+public:
+	/** One instance per ice block, with per-instance collision */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Ice|Components")
+	UHierarchicalInstancedStaticMeshComponent* Blocks;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	int32 CustomDataIndex_MeltAlpha = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	int32 CustomDataIndex_MeltShrink = 1;
+
+	/** First of three consecutive slots: timeline start alpha, start time, end time */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	int32 CustomDataIndex_MeltTimeline = 2;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Melt")
+	float MinScaleRatio = 0.15f;
+
+	/** Melt alpha step at which an instance transform, and with it the instance collision, is updated. The material shrinks the rest */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Melt", meta=(ClampMin=0.01, ClampMax=1.0))
+	float ScaleSnapStep = 0.25f;
+
+	/** Removes an instance once it has fully melted, otherwise it stays at MinScaleRatio */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Melt")
+	bool bRemoveMeltedBlocks = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Physics")
+	float IceDensityKgM3 = 917.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Physics")
+	float LatentHeatJPerKg = 334000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Physics")
+	float SimTimeScale = 3600.0f;
+
+	/** Simulates the blocks as Mass entities, integrated in parallel chunks, instead of packed heat receivers */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Ice|Mass")
+	bool bSimulateAsMass = false;
+
+	/** Blocks within this distance of a player pawn are promoted to actors, 0 disables promotion */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Mass", meta=(ClampMin=0, Units="cm", EditCondition="bSimulateAsMass"))
+	float PromoteRadius = 400.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Mass", meta=(ClampMin=0.01, Units="s", EditCondition="bSimulateAsMass"))
+	float PromoteCheckInterval = 0.25f;
+
+	/** Spawned in place of a promoted block. It should use the same mesh and physics settings as the field */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Mass")
+	TSubclassOf<AIce> PromotedActorClass;
+
+private:
+	/** Stable block key <-> instance index, mirrors the remove-at-swap of the instance buffer */
+	FHeatSlotMap BlockSlots;
+
+	/** Per-instance state, indexed like the HISM instances */
+	TArray<int32> BlockReceiverIds;
+	TArray<FMassEntityHandle> BlockEntities;
+	TArray<float> BlockEnergyJ;
+	TArray<float> BlockAlpha;
+	TArray<FTransform> BlockBaseTransforms;
+	TArray<float> BlockAppliedScale;
+
+	FDelegateHandle MoveHandle;
+	FTimerHandle PromoteTimer;
+
+	void RegisterBlocks();
+	void UnregisterBlocks();
+	void RemoveBlock(int32 InstanceKey);
+	void PromoteNearPlayers();
+	FHeatReceiverBody MakeBlockBody(const FTransform& WorldTransform) const;
+	void ApplyBlockVisual(int32 InstanceIndex, float Alpha01);
+
+	/** Writes a custom data float if it changed, updating only that instance on the render thread */
+	void SetBlockCustomData(int32 InstanceIndex, int32 DataIndex, float Value);
+
+	void OnFieldMoved(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport);
+};
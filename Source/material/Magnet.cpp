@@ -2,6 +2,8 @@
 #include "Components/StaticMeshComponent.h"
 #include "Components/SphereComponent.h"
 #include "Components/PrimitiveComponent.h"
+#include "TickLODSubsystem.h"
+#include "MaterialSimStats.h"
 
 AMagnet::AMagnet()
 {
@@ -33,17 +35,42 @@ void AMagnet::BeginPlay()
 
     MagnetRange->OnComponentBeginOverlap.AddDynamic(this, &AMagnet::OnRangeBegin);
     MagnetRange->OnComponentEndOverlap.AddDynamic(this, &AMagnet::OnRangeEnd);
+
+    if (UTickLODSubsystem* TickLOD = GetWorld()->GetSubsystem<UTickLODSubsystem>())
+    {
+        TickLOD->RegisterActor(this, FOnTickLODChanged::CreateUObject(this, &AMagnet::OnTickLODChanged));
+    }
+}
+
+void AMagnet::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UTickLODSubsystem* TickLOD = GetWorld()->GetSubsystem<UTickLODSubsystem>())
+    {
+        TickLOD->UnregisterActor(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AMagnet::OnTickLODChanged(float Interval)
+{
+    SetActorTickInterval(Interval);
 }
 
 void AMagnet::Tick(float DeltaTime)
 {
+    MATERIALSIM_SCOPE(Magnet_Tick);
+
     Super::Tick(DeltaTime);
 
-    if (OverlappingMetals.Num() == 0)
+    if (!bMagnetEnabled || OverlappingMetals.Num() == 0)
         return;
 
     const FVector MagnetLoc = MagnetMesh->GetComponentLocation();
 
+    // 틱 간격이 있으면 건너뛴 시간만큼 힘 대신 충격량(F * dt)으로 적용
+    const bool bUseImpulse = GetActorTickInterval() > 0.f;
+
     for (UPrimitiveComponent* MetalComp : OverlappingMetals)
     {
         if (!IsValid(MetalComp) || !MetalComp->IsSimulatingPhysics())
@@ -66,15 +93,32 @@ void AMagnet::Tick(float DeltaTime)
         const float MaxForce = 1e6f;
         FinalForce = FinalForce.GetClampedToMaxSize(MaxForce);
 
-        MetalComp->AddForce(FinalForce);
+        if (bUseImpulse)
+        {
+            MetalComp->AddImpulse(FinalForce * DeltaTime);
 
-        if (MagnetMesh->IsSimulatingPhysics())
+            if (MagnetMesh->IsSimulatingPhysics())
+            {
+                MagnetMesh->AddImpulse(-FinalForce * DeltaTime);
+            }
+        }
+        else
         {
-            MagnetMesh->AddForce(-FinalForce);
+            MetalComp->AddForce(FinalForce);
+
+            if (MagnetMesh->IsSimulatingPhysics())
+            {
+                MagnetMesh->AddForce(-FinalForce);
+            }
         }
     }
 }
 
+void AMagnet::SetMagnetEnabled(bool bEnabled)
+{
+    bMagnetEnabled = bEnabled;
+}
+
 void AMagnet::OnRangeBegin(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
     if (!OtherActor || OtherActor == this || !OtherComp)
@@ -19,8 +19,19 @@ public:
 
     virtual void Tick(float DeltaTime) override;
 
+    /** 자석 켜기/끄기. 꺼져 있으면 금속에 힘을 주지 않음 */
+    UFUNCTION(BlueprintCallable, Category="Magnet")
+    void SetMagnetEnabled(bool bEnabled);
+
+    UFUNCTION(BlueprintPure, Category="Magnet")
+    bool IsMagnetEnabled() const { return bMagnetEnabled; }
+
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    /** 거리/화면 기반 틱 간격 변경 (UTickLODSubsystem) */
+    void OnTickLODChanged(float Interval);
 
     /* ===== Components ===== */
 
@@ -62,6 +73,10 @@ protected:
     UPROPERTY(EditAnywhere, Category="Magnet|Physics")
     bool bAutoComputeStrength = true;
 
+    /** 자석 작동 여부 (코옵에서는 서버 값이 복제됨) */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Magnet")
+    bool bMagnetEnabled = true;
+
     /* ===== Runtime ===== */
 
     /** 자기장 안의 금속들 */
@@ -0,0 +1,24 @@
+// MaterialSimStats.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+/** stat MaterialSim */
+DECLARE_STATS_GROUP(TEXT("MaterialSim"), STATGROUP_MaterialSim, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Heat sources"), STAT_MaterialSim_Sources, STATGROUP_MaterialSim, MATERIAL_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Heat receivers"), STAT_MaterialSim_Receivers, STATGROUP_MaterialSim, MATERIAL_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Mass heat receivers"), STAT_MaterialSim_MassReceivers, STATGROUP_MaterialSim, MATERIAL_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Source/receiver pairs"), STAT_MaterialSim_Pairs, STATGROUP_MaterialSim, MATERIAL_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Receiver applies"), STAT_MaterialSim_Applies, STATGROUP_MaterialSim, MATERIAL_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Thermal network edges"), STAT_MaterialSim_NetworkEdges, STATGROUP_MaterialSim, MATERIAL_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Thermal network CG iterations"), STAT_MaterialSim_NetworkIterations, STATGROUP_MaterialSim, MATERIAL_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Form switches"), STAT_MaterialSim_FormSwitches, STATGROUP_MaterialSim, MATERIAL_API);
+
+/** Cycle stat in STATGROUP_MaterialSim plus an Unreal Insights CPU scope, both called Name */
+#define MATERIALSIM_SCOPE(Name) \
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT(#Name), STAT_MaterialSim_##Name, STATGROUP_MaterialSim); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Name)
@@ -0,0 +1,165 @@
+// Puddle.cpp
+
+#include "Puddle.h"
+
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Temperature.h"
+#include "HeatSimSubsystem.h"
+#include "HeatPhaseSubsystem.h"
+#include "HeatSimSettings.h"
+#include "VapourEffect.h"
+
+APuddle::APuddle()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	MeshComp = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("MeshComp"));
+	SetRootComponent(MeshComp);
+
+	MeshComp->SetMobility(EComponentMobility::Movable);
+	MeshComp->SetCollisionProfileName(TEXT("OverlapAllDynamic"));
+	MeshComp->SetCastShadow(false);
+}
+
+void APuddle::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterHeatReceiver();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void APuddle::AddWater(float AddedVolumeM3)
+{
+	if (AddedVolumeM3 <= 0.0f) return;
+
+	if (const UStaticMesh* Mesh = MeshComp->GetStaticMesh())
+	{
+		const FVector SizeM = Mesh->GetBounds().BoxExtent * 2.0f / 100.0f;
+		MeshAreaM2 = FMath::Max(static_cast<float>(SizeM.X * SizeM.Y), 1e-4f);
+	}
+
+	VolumeM3 = GetWaterVolumeM3() + AddedVolumeM3;
+	EvaporatedAlpha = 0.0f;
+	EnergyAccumJ = 0.0f;
+
+	ApplyEvaporationVisual();
+
+	// refreshes the body when already registered, the reset energy replaces a running evaporation prediction
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->RegisterReceiver(this, true);
+	}
+}
+
+void APuddle::ApplyHeatSimState(float NewEnergyJ, float NewMeltAlpha, float ReceivedPowerW, float DistCm, float DeltaTime)
+{
+	if (VolumeM3 <= 0.0f) return;
+
+	EnergyAccumJ = NewEnergyJ;
+	EvaporatedAlpha = NewMeltAlpha;
+
+	ApplyEvaporationVisual();
+	UpdateVapour(ReceivedPowerW);
+
+	if (EvaporatedAlpha >= 1.0f)
+	{
+		UActorPoolSubsystem::ReleaseOrDestroy(this);
+	}
+}
+
+void APuddle::OnReturnedToPool()
+{
+	UnregisterHeatReceiver();
+
+	// the vapour lingers on its own and goes back to the pool after
+	Vapour.Reset();
+	HeatingFires.Reset();
+
+	VolumeM3 = 0.0f;
+	EvaporatedAlpha = 0.0f;
+	EnergyAccumJ = 0.0f;
+}
+
+void APuddle::StartHeating_Implementation(ATemperature* FireRef)
+{
+	if (!FireRef) return;
+
+	HeatingFires.AddUnique(FireRef);
+
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->AddReceiverSource(this, FireRef);
+	}
+}
+
+void APuddle::StopHeating_Implementation(ATemperature* FireRef)
+{
+	HeatingFires.RemoveSingleSwap(FireRef);
+
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->RemoveReceiverSource(this, FireRef);
+	}
+}
+
+bool APuddle::IsHeating_Implementation() const
+{
+	return HeatingFires.Num() > 0;
+}
+
+bool APuddle::GetHeatReceiverBody(FHeatReceiverBody& OutBody, float& OutEnergyAccumJ) const
+{
+	if (VolumeM3 <= 0.0f) return false;
+
+	const float MassKg = GetDefault<UHeatSimSettings>()->WaterDensityKgM3 * VolumeM3;
+
+	OutBody.VolumeM3 = VolumeM3;
+	OutBody.EffectiveAreaM2 = FMath::Max(VolumeM3 / (DepthCm / 100.0f), MinAreaM2);
+	OutBody.TotalMeltEnergyJ = FMath::Max(MassKg * (SpecificHeatJPerKgK * HeatUpToBoilK + LatentHeatVaporJPerKg), 1.0f);
+	OutBody.SimTimeScale = SimTimeScale;
+	OutBody.bCanMelt = true;
+	OutEnergyAccumJ = EnergyAccumJ;
+	return true;
+}
+
+void APuddle::ApplyEvaporationVisual()
+{
+	const float AreaM2 = FMath::Max(GetWaterVolumeM3() / (DepthCm / 100.0f), MinAreaM2);
+	const float Spread = FMath::Sqrt(AreaM2 / MeshAreaM2);
+
+	const FVector Scale(Spread, Spread, 1.0f);
+	if (!MeshComp->GetRelativeScale3D().Equals(Scale, 1e-3f))
+	{
+		MeshComp->SetRelativeScale3D(Scale);
+	}
+
+	MeshComp->SetCustomPrimitiveDataFloat(CPDIndex_Evaporation, EvaporatedAlpha);
+}
+
+void APuddle::UpdateVapour(float ReceivedPowerW)
+{
+	if (ReceivedPowerW <= 0.0f) return;
+
+	// a pooled effect may already be lingering for another puddle, only keep it while it is still ours
+	AVapourEffect* Effect = Vapour.Get();
+	if (!Effect || Effect->GetOwner() != this)
+	{
+		UHeatPhaseSubsystem* Phase = GetWorld()->GetSubsystem<UHeatPhaseSubsystem>();
+		Effect = Phase ? Phase->AcquireVapour(this) : nullptr;
+		Vapour = Effect;
+	}
+
+	if (Effect)
+	{
+		Effect->Refresh(ReceivedPowerW, VapourLinger);
+	}
+}
+
+void APuddle::UnregisterHeatReceiver()
+{
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->UnregisterReceiver(this);
+	}
+}
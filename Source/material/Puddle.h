@@ -0,0 +1,101 @@
+// Puddle.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "HeatReceiver.h"
+#include "ActorPoolSubsystem.h"
+#include "Puddle.generated.h"
+
+class UStaticMeshComponent;
+class AVapourEffect;
+class ATemperature;
+
+/**
+ *  Melt water left behind by ice. Holds a water volume spread to DepthCm, and is itself a heat receiver:
+ *  its melt alpha is the evaporated fraction, which shrinks the puddle and feeds a vapour effect while heated.
+ *  Puddles are recycled through UActorPoolSubsystem by UHeatPhaseSubsystem, never spawned per melt.
+ */
+UCLASS()
+class MATERIAL_API APuddle : public AActor, public IHeatReceiver, public IPooledActor
+{
+	GENERATED_BODY()
+
+public:
+	APuddle();
+
+protected:
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	// ~begin IHeatReceiver interface
+	virtual void StartHeating_Implementation(ATemperature* FireRef) override;
+	virtual void StopHeating_Implementation(ATemperature* FireRef) override;
+	virtual bool IsHeating_Implementation() const override;
+	virtual bool GetHeatReceiverBody(FHeatReceiverBody& OutBody, float& OutEnergyAccumJ) const override;
+	virtual void ApplyHeatSimState(float NewEnergyJ, float NewMeltAlpha, float ReceivedPowerW, float DistCm, float DeltaTime) override;
+	// ~end IHeatReceiver interface
+
+	// ~begin IPooledActor interface
+	virtual void OnReturnedToPool() override;
+	// ~end IPooledActor interface
+
+	/** Adds melt water. The evaporated part of the old volume is dropped and the evaporation restarts on the sum */
+	UFUNCTION(BlueprintCallable, Category="Puddle")
+	void AddWater(float AddedVolumeM3);
+
+	/** Water still in the puddle */
+	UFUNCTION(BlueprintPure, Category="Puddle")
+	float GetWaterVolumeM3() const { return VolumeM3 * (1.0f - EvaporatedAlpha); }
+
+public:
+	/** Flat mesh, scaled in X and Y to the puddle area */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Puddle|Components")
+	UStaticMeshComponent* MeshComp;
+
+	/** Custom primitive data slot receiving the evaporated fraction */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Puddle|Visual")
+	int32 CPDIndex_Evaporation = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Puddle|Physics", meta=(ClampMin=0.1, Units="cm"))
+	float DepthCm = 1.0f;
+
+	/** Puddles never shrink below this area, the last of the water just gets shallower */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Puddle|Physics", meta=(ClampMin=0))
+	float MinAreaM2 = 0.01f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Puddle|Physics")
+	float SpecificHeatJPerKgK = 4186.0f;
+
+	/** Heating from melt water temperature up to boiling, added to the latent heat of every kilogram */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Puddle|Physics", meta=(Units="K"))
+	float HeatUpToBoilK = 100.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Puddle|Physics")
+	float LatentHeatVaporJPerKg = 2260000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Puddle|Physics")
+	float SimTimeScale = 3600.0f;
+
+	/** Seconds the vapour keeps going after the last heated step */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Puddle|Visual", meta=(ClampMin=0, Units="s"))
+	float VapourLinger = 1.0f;
+
+private:
+	UPROPERTY(Transient)
+	TArray<ATemperature*> HeatingFires;
+
+	TWeakObjectPtr<AVapourEffect> Vapour;
+
+	float VolumeM3 = 0.0f;
+	float EvaporatedAlpha = 0.0f;
+	float EnergyAccumJ = 0.0f;
+
+	/** Footprint of the mesh at unit scale */
+	float MeshAreaM2 = 1.0f;
+
+	void ApplyEvaporationVisual();
+	void UpdateVapour(float ReceivedPowerW);
+	void UnregisterHeatReceiver();
+};
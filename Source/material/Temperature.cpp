@@ -2,13 +2,14 @@
 
 #include "Components/SphereComponent.h"
 #include "Components/StaticMeshComponent.h"
-#include "Components/PrimitiveComponent.h"
 #include "Materials/MaterialInterface.h"
 #include "Materials/MaterialInstanceDynamic.h"
+#include "HeatSimSubsystem.h"
+#include "MaterialSimStats.h"
 
 ATemperature::ATemperature()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
 	SetRootComponent(Root);
@@ -19,8 +20,9 @@ ATemperature::ATemperature()
 	HeatSphere = CreateDefaultSubobject<USphereComponent>(TEXT("HeatSphere"));
 	HeatSphere->SetupAttachment(Root);
 
-	HeatSphere->SetCollisionProfileName(TEXT("Trigger"));
-	HeatSphere->SetGenerateOverlapEvents(true);
+	// the heat radius is only a visual, pairing is done by UHeatSimSubsystem
+	HeatSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	HeatSphere->SetGenerateOverlapEvents(false);
 
 	HeatSphere->bDrawOnlyIfSelected = false;
 	HeatSphere->ShapeColor = FColor::Red;
@@ -32,7 +34,7 @@ void ATemperature::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
 
-	UpdateSphereRadius(false);
+	UpdateSphereRadius();
 	UpdateVisuals();
 }
 
@@ -40,36 +42,83 @@ void ATemperature::BeginPlay()
 {
 	Super::BeginPlay();
 
-	UpdateSphereRadius(true);
+	UpdateSphereRadius();
 	UpdateVisuals();
 
-	if (HeatSphere)
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
 	{
-		HeatSphere->OnComponentBeginOverlap.AddDynamic(this, &ATemperature::OnSphereBeginOverlap);
-		HeatSphere->OnComponentEndOverlap.AddDynamic(this, &ATemperature::OnSphereEndOverlap);
+		HeatSourceId = HeatSim->RegisterSource(this);
+	}
+}
 
-		HeatSphere->UpdateOverlaps();
-		StartHeatingOnAlreadyOverlapping();
+void ATemperature::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (HeatSourceId != INDEX_NONE)
+	{
+		if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+		{
+			HeatSim->UnregisterSource(HeatSourceId);
+		}
+		HeatSourceId = INDEX_NONE;
 	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void ATemperature::Tick(float DeltaTime)
+void ATemperature::AdvanceHeat(float DeltaTime)
 {
-	Super::Tick(DeltaTime);
+	MATERIALSIM_SCOPE(Temperature_AdvanceHeat);
 
 	if (CoolRate > 0.f)
 	{
 		Temperature = FMath::Max(0.f, Temperature - CoolRate * DeltaTime);
 	}
+}
 
-	UpdateSphereRadius(false);
+void ATemperature::UpdateHeatVisuals()
+{
+	UpdateSphereRadius();
 	UpdateVisuals();
-	CheckAndUpdateIceObjects();  // ← 추가!
+}
+
+void ATemperature::SetTemperature(float NewTemperature)
+{
+	if (Temperature == NewTemperature) return;
+
+	Temperature = NewTemperature;
+	UpdateVisuals();
+	WakeHeat();
+}
+
+void ATemperature::SetMaxHeatDistance(float NewMaxHeatDistance)
+{
+	if (MaxHeatDistance == NewMaxHeatDistance) return;
+
+	MaxHeatDistance = NewMaxHeatDistance;
+	UpdateSphereRadius();
+	WakeHeat();
+}
+
+void ATemperature::WakeHeat()
+{
+	if (HeatSourceId == INDEX_NONE) return;
+
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->WakeSource(HeatSourceId);
+	}
 }
 
 float ATemperature::GetTotalRadiantPowerW() const
 {
-	const double T_K = static_cast<double>(Temperature) + 273.15;
+	return GetRadiantPowerAfterW(0.f);
+}
+
+float ATemperature::GetRadiantPowerAfterW(float Seconds) const
+{
+	const float CooledTemperature = CoolRate > 0.f ? FMath::Max(0.f, Temperature - CoolRate * Seconds) : Temperature;
+
+	const double T_K = static_cast<double>(CooledTemperature) + 273.15;
 	const double P = static_cast<double>(Emissivity) *
 		static_cast<double>(StefanBoltzmannSigma) *
 		static_cast<double>(SurfaceAreaM2) *
@@ -108,43 +157,16 @@ float ATemperature::GetReceivedPowerW(const FVector& WorldLocation, float Receiv
 	return q * FMath::Max(ReceiverAreaM2, 0.f);
 }
 
-void ATemperature::OnSphereBeginOverlap(
-	UPrimitiveComponent* OverlappedComp,
-	AActor* OtherActor,
-	UPrimitiveComponent* OtherComp,
-	int32 OtherBodyIndex,
-	bool bFromSweep,
-	const FHitResult& SweepResult)
+TArray<TScriptInterface<IHeatReceiver>> ATemperature::GetReceiversInRange() const
 {
-	if (!OtherActor || OtherActor == this) return;
-	if (IceClassFilter && !OtherActor->IsA(IceClassFilter)) return;
-
-	static const FName FnName(TEXT("StartHeating"));
-	if (UFunction* Fn = OtherActor->FindFunction(FnName))
+	if (const UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
 	{
-		struct FArgs { ATemperature* FireRef; };
-		FArgs Args{ this };
-		OtherActor->ProcessEvent(Fn, &Args);
+		return HeatSim->GetReceiversInRange(this);
 	}
+	return TArray<TScriptInterface<IHeatReceiver>>();
 }
 
-void ATemperature::OnSphereEndOverlap(
-	UPrimitiveComponent* OverlappedComp,
-	AActor* OtherActor,
-	UPrimitiveComponent* OtherComp,
-	int32 OtherBodyIndex)
-{
-	if (!OtherActor || OtherActor == this) return;
-	if (IceClassFilter && !OtherActor->IsA(IceClassFilter)) return;
-
-	static const FName FnName(TEXT("StopHeating"));
-	if (UFunction* Fn = OtherActor->FindFunction(FnName))
-	{
-		OtherActor->ProcessEvent(Fn, nullptr);
-	}
-}
-
-void ATemperature::UpdateSphereRadius(bool bForceOverlaps)
+void ATemperature::UpdateSphereRadius()
 {
 	if (!HeatSphere) return;
 
@@ -153,41 +175,15 @@ void ATemperature::UpdateSphereRadius(bool bForceOverlaps)
 	const bool bChanged = !FMath::IsNearlyEqual(R, LastSphereRadius, 0.01f);
 	if (bChanged)
 	{
-		HeatSphere->SetSphereRadius(R, true);
+		HeatSphere->SetSphereRadius(R, false);
 		LastSphereRadius = R;
 	}
 
-	if (bForceOverlaps || bChanged)
+	if (bChanged && HeatSourceId != INDEX_NONE)
 	{
-		HeatSphere->UpdateOverlaps();
-	}
-}
-
-void ATemperature::StartHeatingOnAlreadyOverlapping()
-{
-	if (!HeatSphere) return;
-
-	TArray<AActor*> Overlaps;
-	if (IceClassFilter)
-	{
-		HeatSphere->GetOverlappingActors(Overlaps, IceClassFilter);
-	}
-	else
-	{
-		HeatSphere->GetOverlappingActors(Overlaps);
-	}
-
-	for (AActor* A : Overlaps)
-	{
-		if (!A || A == this) continue;
-		if (IceClassFilter && !A->IsA(IceClassFilter)) continue;
-
-		static const FName FnName(TEXT("StartHeating"));
-		if (UFunction* Fn = A->FindFunction(FnName))
+		if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
 		{
-			struct FArgs { ATemperature* FireRef; };
-			FArgs Args{ this };
-			A->ProcessEvent(Fn, &Args);
+			HeatSim->MarkSourceDirty(HeatSourceId);
 		}
 	}
 }
@@ -196,62 +192,28 @@ void ATemperature::UpdateVisuals()
 {
 	if (!MeshComp) return;
 
-	if (bUseDynamicMaterial && HeatMaterial)
-	{
-		if (!HeatMID)
-		{
-			HeatMID = UMaterialInstanceDynamic::Create(HeatMaterial, this);
-			MeshComp->SetMaterial(0, HeatMID);
-		}
-		if (HeatMID)
-		{
-			const float HeatAlpha = FMath::Clamp(Temperature * TempScale, 0.f, 1.f);
-			HeatMID->SetScalarParameterValue(HeatAlphaParamName, HeatAlpha);
-		}
-	}
+	const float HeatAlpha = FMath::Clamp(Temperature * TempScale, 0.f, 1.f);
 
 	if (bUseCPD)
 	{
-		MeshComp->SetCustomPrimitiveDataFloat(CPDIndex_Temperature, Temperature);
-	}
-}
-
-void ATemperature::CheckAndUpdateIceObjects()
-{
-	if (!HeatSphere) return;
+		// every source shares HeatMaterial so they can batch, per-actor values live in custom primitive data
+		if (HeatMaterial && MeshComp->GetMaterial(0) != HeatMaterial)
+		{
+			MeshComp->SetMaterial(0, HeatMaterial);
+		}
 
-	TArray<AActor*> OverlappingActors;
-	if (IceClassFilter)
-	{
-		HeatSphere->GetOverlappingActors(OverlappingActors, IceClassFilter);
-	}
-	else
-	{
-		HeatSphere->GetOverlappingActors(OverlappingActors);
+		TemperatureParam.Set(MeshComp, nullptr, true, NAME_None, CPDIndex_Temperature, Temperature);
+		HeatAlphaParam.Set(MeshComp, nullptr, true, NAME_None, CPDIndex_HeatAlpha, HeatAlpha);
 	}
-
-	static const FName StartFn(TEXT("StartHeating"));
-	static const FName IsHeatingFn(TEXT("IsHeating"));
-
-	for (AActor* Actor : OverlappingActors)
+	else if (bUseDynamicMaterial && HeatMaterial)
 	{
-		if (!Actor || Actor == this) continue;
-		if (IceClassFilter && !Actor->IsA(IceClassFilter)) continue;
-
-		bool bAlreadyHeating = false;
-		if (UFunction* CheckFn = Actor->FindFunction(IsHeatingFn))
+		if (!HeatMID)
 		{
-			Actor->ProcessEvent(CheckFn, &bAlreadyHeating);
+			HeatMID = UMaterialInstanceDynamic::Create(HeatMaterial, this);
+			MeshComp->SetMaterial(0, HeatMID);
+			HeatAlphaParam.Invalidate();
 		}
 
-		if (!bAlreadyHeating)
-		{
-			if (UFunction* Fn = Actor->FindFunction(StartFn))
-			{
-				struct FArgs { ATemperature* FireRef; };
-				FArgs Args{ this };
-				Actor->ProcessEvent(Fn, &Args);
-			}
-		}
+		HeatAlphaParam.Set(MeshComp, HeatMID, false, HeatAlphaParamName, INDEX_NONE, HeatAlpha);
 	}
 }
\ No newline at end of file
@@ -5,13 +5,14 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Engine/EngineTypes.h"
+#include "HeatReceiver.h"
+#include "HeatVisualParam.h"
 #include "Temperature.generated.h"
 
 class USphereComponent;
 class UStaticMeshComponent;
 class UMaterialInterface;
 class UMaterialInstanceDynamic;
-class UPrimitiveComponent;
 
 UCLASS()
 class MATERIAL_API ATemperature : public AActor
@@ -23,13 +24,39 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void OnConstruction(const FTransform& Transform) override;
 
 public:
+	/** Advances cooling by one heat sim step. Called by UHeatSimSubsystem instead of Tick */
+	void AdvanceHeat(float DeltaTime);
+
+	/** Pushes the current temperature to the material. Called by UHeatSimSubsystem once per frame after its steps */
+	void UpdateHeatVisuals();
+
+	int32 GetHeatSourceId() const { return HeatSourceId; }
+
+	/** True once nothing changes between steps any more, e.g. fully cooled down. The sim stops advancing it until woken */
+	bool IsHeatSteady() const { return CoolRate <= 0.f || Temperature <= 0.f; }
+
+	/** Sets the temperature and wakes the source if it went dormant */
+	UFUNCTION(BlueprintSetter)
+	void SetTemperature(float NewTemperature);
+
+	UFUNCTION(BlueprintSetter)
+	void SetMaxHeatDistance(float NewMaxHeatDistance);
+
+	/** Wakes a dormant source after any other heat setting was changed */
+	UFUNCTION(BlueprintCallable, Category="Heat")
+	void WakeHeat();
+
 	UFUNCTION(BlueprintCallable, Category="Heat")
 	float GetTotalRadiantPowerW() const;
 
+	/** Radiant power once Seconds more of cooling have passed, without advancing the source */
+	float GetRadiantPowerAfterW(float Seconds) const;
+
+	/** Unoccluded flux from distance alone. UHeatSimSubsystem additionally scales each receiver pair by line of sight */
 	UFUNCTION(BlueprintCallable, Category="Heat")
 	float GetHeatFluxWm2AtLocation(const FVector& WorldLocation) const;
 
@@ -39,6 +66,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Heat")
 	float GetReceivedPowerW(const FVector& WorldLocation, float ReceiverAreaM2 = 1.0f) const;
 
+	/** Returns every heat receiver currently within MaxHeatDistance */
+	UFUNCTION(BlueprintCallable, Category="Heat")
+	TArray<TScriptInterface<IHeatReceiver>> GetReceiversInRange() const;
+
 private:
 	UPROPERTY(VisibleAnywhere, Category="Components")
 	USceneComponent* Root;
@@ -50,10 +81,10 @@ private:
 	USphereComponent* HeatSphere;
 
 public:
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Heat|Settings")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter=SetTemperature, Category="Heat|Settings")
 	float Temperature = 600.0f;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Heat|Settings")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter=SetMaxHeatDistance, Category="Heat|Settings")
 	float MaxHeatDistance = 500.0f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Heat|Settings")
@@ -83,38 +114,27 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Heat|Visual")
 	float TempScale = 0.002f;
 
+	/** Pushes Temperature and HeatAlpha through custom primitive data on the shared HeatMaterial instead of a per-actor MID */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Heat|Visual")
 	bool bUseCPD = false;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Heat|Visual")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Heat|Visual", meta=(EditCondition="bUseCPD"))
 	int32 CPDIndex_Temperature = 0;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Heat|Visual", meta=(EditCondition="bUseCPD"))
+	int32 CPDIndex_HeatAlpha = 1;
+
 private:
 	UPROPERTY(Transient)
 	UMaterialInstanceDynamic* HeatMID = nullptr;
 
 	float LastSphereRadius = -1.0f;
 
-	UFUNCTION()
-	void OnSphereBeginOverlap(
-		UPrimitiveComponent* OverlappedComp,
-		AActor* OtherActor,
-		UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex,
-		bool bFromSweep,
-		const FHitResult& SweepResult
-	);
-
-	UFUNCTION()
-	void OnSphereEndOverlap(
-		UPrimitiveComponent* OverlappedComp,
-		AActor* OtherActor,
-		UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex
-	);
-
-	void UpdateSphereRadius(bool bForceOverlaps);
-	void StartHeatingOnAlreadyOverlapping();
+	FHeatVisualParam HeatAlphaParam;
+	FHeatVisualParam TemperatureParam;
+
+	int32 HeatSourceId = INDEX_NONE;
+
+	void UpdateSphereRadius();
 	void UpdateVisuals();
-	void CheckAndUpdateIceObjects();
 };
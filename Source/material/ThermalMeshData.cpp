@@ -0,0 +1,89 @@
+// ThermalMeshData.cpp
+
+#include "ThermalMeshData.h"
+
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+#include "UObject/ObjectSaveContext.h"
+#include "material.h"
+
+void UThermalMeshData::GetScaledBody(const UStaticMesh* Mesh, const FVector& Scale, float& OutVolumeM3, float& OutEffectiveAreaM2)
+{
+	if (!Mesh)
+	{
+		OutVolumeM3 = 1.0f;
+		OutEffectiveAreaM2 = 1.0f;
+		return;
+	}
+
+	const FVector S = Scale.GetAbs();
+
+	const UThermalMeshData* Data = const_cast<UStaticMesh*>(Mesh)->GetAssetUserData<UThermalMeshData>();
+	if (Data && Data->IsValid())
+	{
+		// an outline seen along X stretches with Y and Z, and so on
+		OutVolumeM3 = FMath::Max(Data->VolumeM3 * static_cast<float>(S.X * S.Y * S.Z), 1e-6f);
+		OutEffectiveAreaM2 = FMath::Max3(
+			Data->ProjectedAreaM2.X * static_cast<float>(S.Y * S.Z),
+			Data->ProjectedAreaM2.Y * static_cast<float>(S.X * S.Z),
+			Data->ProjectedAreaM2.Z * static_cast<float>(S.X * S.Y));
+		return;
+	}
+
+	const FVector SizeM = Mesh->GetBounds().BoxExtent * S * 2.0f / 100.0f;
+
+	OutVolumeM3 = FMath::Max(SizeM.X * SizeM.Y * SizeM.Z, 1e-6f);
+	OutEffectiveAreaM2 = FMath::Max3(SizeM.X * SizeM.Y, SizeM.X * SizeM.Z, SizeM.Y * SizeM.Z);
+}
+
+#if WITH_EDITOR
+void UThermalMeshData::Compute(const UStaticMesh* Mesh)
+{
+	const FStaticMeshRenderData* RenderData = Mesh ? Mesh->GetRenderData() : nullptr;
+	if (!RenderData || RenderData->LODResources.IsEmpty()) return;
+
+	const FStaticMeshLODResources& LOD = RenderData->LODResources[0];
+	const FPositionVertexBuffer& Positions = LOD.VertexBuffers.PositionVertexBuffer;
+	const FIndexArrayView Indices = LOD.IndexBuffer.GetArrayView();
+
+	// divergence theorem: each triangle adds the signed volume of its tetrahedron to the origin.
+	// Projected areas count every triangle's area vector on both sides of a closed surface, hence the halving
+	double Volume = 0.0;
+	double Area = 0.0;
+	FVector3d Projected = FVector3d::ZeroVector;
+
+	for (const FStaticMeshSection& Section : LOD.Sections)
+	{
+		const uint32 End = Section.FirstIndex + Section.NumTriangles * 3;
+		for (uint32 i = Section.FirstIndex; i < End; i += 3)
+		{
+			const FVector3d P0(Positions.VertexPosition(Indices[i]));
+			const FVector3d P1(Positions.VertexPosition(Indices[i + 1]));
+			const FVector3d P2(Positions.VertexPosition(Indices[i + 2]));
+
+			Volume += FVector3d::DotProduct(P0, FVector3d::CrossProduct(P1, P2)) / 6.0;
+
+			const FVector3d AreaVector = FVector3d::CrossProduct(P1 - P0, P2 - P0) * 0.5;
+			Area += AreaVector.Size();
+			Projected += AreaVector.GetAbs() * 0.5;
+		}
+	}
+
+	// winding only flips the sign; an open mesh gives a meaningless number and keeps the bounds fallback
+	VolumeM3 = static_cast<float>(FMath::Abs(Volume) / 1.0e6);
+	SurfaceAreaM2 = static_cast<float>(Area / 1.0e4);
+	ProjectedAreaM2 = FVector3f(Projected / 1.0e4);
+
+	if (!IsValid())
+	{
+		UE_LOG(Logmaterial, Warning, TEXT("thermal mesh data: %s encloses no volume, using its bounds instead"), *Mesh->GetName());
+	}
+}
+
+void UThermalMeshData::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+
+	Compute(Cast<UStaticMesh>(GetOuter()));
+}
+#endif
@@ -0,0 +1,49 @@
+// ThermalMeshData.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/AssetUserData.h"
+#include "ThermalMeshData.generated.h"
+
+class UStaticMesh;
+
+/**
+ *  Enclosed volume and surface of a static mesh at unit scale, for the heat sim's mass and melt energy.
+ *  Add it to an ice mesh's Asset User Data; it is filled in from LOD0 whenever the mesh is saved or cooked,
+ *  so runtime only has to apply the component's scale.
+ */
+UCLASS(BlueprintType, meta=(DisplayName="Thermal Mesh Data"))
+class MATERIAL_API UThermalMeshData : public UAssetUserData
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Thermal")
+	float VolumeM3 = 0.0f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Thermal")
+	float SurfaceAreaM2 = 0.0f;
+
+	/** Area of the mesh's outline seen along X, Y and Z. For a box these are its faces */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Thermal")
+	FVector3f ProjectedAreaM2 = FVector3f::ZeroVector;
+
+	bool IsValid() const { return VolumeM3 > 0.0f; }
+
+	/**
+	 *  Volume and the largest projected area of Mesh at Scale, from its thermal data when it has some and
+	 *  from the bounds box otherwise
+	 */
+	static void GetScaledBody(const UStaticMesh* Mesh, const FVector& Scale, float& OutVolumeM3, float& OutEffectiveAreaM2);
+
+#if WITH_EDITOR
+	/** Fills the data from the triangles of Mesh's LOD0 */
+	void Compute(const UStaticMesh* Mesh);
+
+	// ~begin UObject interface
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+	// ~end UObject interface
+#endif
+};
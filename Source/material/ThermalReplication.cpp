@@ -0,0 +1,98 @@
+// ThermalReplication.cpp
+
+#include "ThermalReplication.h"
+
+#include "Engine/World.h"
+#include "ActorPoolSubsystem.h"
+#include "Ice.h"
+#include "Transformation_actor.h"
+#include "Temperature.h"
+#include "Magnet.h"
+
+uint8 FThermalRepItem::QuantizeAlpha(float Alpha)
+{
+	// rounding up to 255 would melt the block on clients before the server does
+	if (Alpha >= 1.0f) return 255;
+	return static_cast<uint8>(FMath::Clamp(FMath::FloorToInt32(Alpha * 255.0f), 0, 254));
+}
+
+uint16 FThermalRepItem::QuantizeTemperature(float Temperature)
+{
+	return static_cast<uint16>(FMath::Clamp(FMath::RoundToInt32(Temperature), 0, MAX_uint16));
+}
+
+bool FThermalRepItem::Capture()
+{
+	uint8 NewMeltAlpha = MeltAlpha;
+	uint8 NewForm = Form;
+	uint8 NewFlags = Flags;
+	uint16 NewTemperature = Temperature;
+
+	if (const AIce* Ice = Cast<AIce>(Actor))
+	{
+		NewMeltAlpha = QuantizeAlpha(Ice->MeltAlpha);
+	}
+	else if (const ATransformation_actor* Block = Cast<ATransformation_actor>(Actor))
+	{
+		NewMeltAlpha = QuantizeAlpha(Block->GetMeltAlpha());
+		NewForm = static_cast<uint8>(Block->CurrentForm);
+	}
+	else if (const ATemperature* Source = Cast<ATemperature>(Actor))
+	{
+		NewTemperature = QuantizeTemperature(Source->Temperature);
+	}
+	else if (const AMagnet* Magnet = Cast<AMagnet>(Actor))
+	{
+		NewFlags = Magnet->IsMagnetEnabled() ? MagnetEnabledFlag : 0;
+	}
+
+	if (NewMeltAlpha == MeltAlpha && NewForm == Form && NewFlags == Flags && NewTemperature == Temperature) return false;
+
+	MeltAlpha = NewMeltAlpha;
+	Form = NewForm;
+	Flags = NewFlags;
+	Temperature = NewTemperature;
+	return true;
+}
+
+void FThermalRepItem::Apply() const
+{
+	if (!IsValid(Actor)) return;
+
+	UActorPoolSubsystem* Pool = Actor->GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+	if (Pool && Pool->IsParked(Actor))
+	{
+		// already melted and parked here, applying would register the hidden block with the heat sim again
+		if (MeltAlpha == 255) return;
+
+		// the client melted the block ahead of the server, bring it back
+		Pool->Reclaim(Actor, Actor->GetActorTransform());
+	}
+
+	if (AIce* Ice = Cast<AIce>(Actor))
+	{
+		Ice->ApplyReplicatedMelt(DequantizeAlpha(MeltAlpha));
+	}
+	else if (ATransformation_actor* Block = Cast<ATransformation_actor>(Actor))
+	{
+		Block->ApplyReplicatedState(static_cast<EBlockForm>(Form), DequantizeAlpha(MeltAlpha));
+	}
+	else if (ATemperature* Source = Cast<ATemperature>(Actor))
+	{
+		Source->SetTemperature(DequantizeTemperature(Temperature));
+	}
+	else if (AMagnet* Magnet = Cast<AMagnet>(Actor))
+	{
+		Magnet->SetMagnetEnabled((Flags & MagnetEnabledFlag) != 0);
+	}
+}
+
+void FThermalRepItem::PostReplicatedAdd(const FThermalRepArray& InArraySerializer)
+{
+	Apply();
+}
+
+void FThermalRepItem::PostReplicatedChange(const FThermalRepArray& InArraySerializer)
+{
+	Apply();
+}
@@ -0,0 +1,80 @@
+// ThermalReplication.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "ThermalReplication.generated.h"
+
+struct FThermalRepArray;
+
+/**
+ *  Quantized thermal state of one level actor: an AIce, ATransformation_actor, ATemperature or AMagnet.
+ *  Only fields that apply to the actor's class are used. Alpha goes in 1/255 steps and temperature in whole
+ *  degrees, so an entry is only re-sent once the change is visible.
+ */
+USTRUCT()
+struct FThermalRepItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	static constexpr uint8 MagnetEnabledFlag = 1 << 0;
+
+	UPROPERTY()
+	TObjectPtr<AActor> Actor;
+
+	/** 255 only once fully melted */
+	UPROPERTY()
+	uint8 MeltAlpha = 0;
+
+	/** EBlockForm */
+	UPROPERTY()
+	uint8 Form = 0;
+
+	UPROPERTY()
+	uint8 Flags = 0;
+
+	UPROPERTY()
+	uint16 Temperature = 0;
+
+	/** Quantizes the actor's current state into the item. True if anything changed. Server only */
+	bool Capture();
+
+	/** Pushes the replicated state onto the actor. Client only */
+	void Apply() const;
+
+	// ~begin FFastArraySerializerItem interface
+	void PostReplicatedAdd(const FThermalRepArray& InArraySerializer);
+	void PostReplicatedChange(const FThermalRepArray& InArraySerializer);
+	// ~end FFastArraySerializerItem interface
+
+	static uint8 QuantizeAlpha(float Alpha);
+	static float DequantizeAlpha(uint8 Quantized) { return Quantized / 255.0f; }
+
+	static uint16 QuantizeTemperature(float Temperature);
+	static float DequantizeTemperature(uint16 Quantized) { return static_cast<float>(Quantized); }
+};
+
+/** Thermal state of every tracked actor in one AThermalRoomVolume. Only changed items are sent */
+USTRUCT()
+struct FThermalRepArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FThermalRepItem> Items;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FThermalRepItem, FThermalRepArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FThermalRepArray> : public TStructOpsTypeTraitsBase2<FThermalRepArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
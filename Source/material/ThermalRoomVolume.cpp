@@ -0,0 +1,287 @@
+// ThermalRoomVolume.cpp
+
+#include "ThermalRoomVolume.h"
+
+#include "Components/BoxComponent.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "TimerManager.h"
+#include "HeatSimSubsystem.h"
+#include "Ice.h"
+#include "Transformation_actor.h"
+#include "Temperature.h"
+#include "Magnet.h"
+#include "MaterialSimStats.h"
+
+AThermalRoomVolume::AThermalRoomVolume()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Box = CreateDefaultSubobject<UBoxComponent>(TEXT("Box"));
+	SetRootComponent(Box);
+
+	Box->SetBoxExtent(FVector(500.0f, 500.0f, 200.0f));
+	Box->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Box->SetGenerateOverlapEvents(false);
+	Box->ShapeColor = FColor::Orange;
+
+	// the state is small and shared by every player in the room
+	bReplicates = true;
+	bAlwaysRelevant = true;
+}
+
+void AThermalRoomVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bConduction)
+	{
+		BuildGrid();
+
+		if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+		{
+			HeatSim->RegisterRoom(this);
+		}
+	}
+
+	if (!bReplicateThermalState)
+	{
+		SetReplicates(false);
+	}
+	else if (HasAuthority() && GetNetMode() != NM_Standalone)
+	{
+		GatherReplicatedActors();
+		GetWorldTimerManager().SetTimer(ReplicationTimer, this, &AThermalRoomVolume::CaptureThermalState, FMath::Max(ReplicationInterval, 0.02f), true);
+	}
+}
+
+void AThermalRoomVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(ReplicationTimer);
+
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->UnregisterRoom(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AThermalRoomVolume::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AThermalRoomVolume, ThermalState, Params);
+}
+
+void AThermalRoomVolume::GatherReplicatedActors()
+{
+	const FTransform& BoxTransform = Box->GetComponentTransform();
+	const FVector Extent = Box->GetUnscaledBoxExtent();
+
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		AActor* Actor = *It;
+		if (!Actor->IsA<AIce>() && !Actor->IsA<ATransformation_actor>() && !Actor->IsA<ATemperature>() && !Actor->IsA<AMagnet>()) continue;
+
+		// clients resolve the entry by path, which only works for actors loaded with the level
+		if (!Actor->IsNameStableForNetworking()) continue;
+
+		const FVector Local = BoxTransform.InverseTransformPosition(Actor->GetActorLocation());
+		if (FMath::Abs(Local.X) > Extent.X || FMath::Abs(Local.Y) > Extent.Y || FMath::Abs(Local.Z) > Extent.Z) continue;
+
+		FThermalRepItem& Item = ThermalState.Items.AddDefaulted_GetRef();
+		Item.Actor = Actor;
+		Item.Capture();
+		ThermalState.MarkItemDirty(Item);
+	}
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(AThermalRoomVolume, ThermalState, this);
+}
+
+void AThermalRoomVolume::CaptureThermalState()
+{
+	MATERIALSIM_SCOPE(Room_CaptureReplication);
+
+	bool bChanged = false;
+	for (FThermalRepItem& Item : ThermalState.Items)
+	{
+		if (Item.Capture())
+		{
+			ThermalState.MarkItemDirty(Item);
+			bChanged = true;
+		}
+	}
+
+	// nothing is compared or sent for a room whose state did not change
+	if (bChanged)
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(AThermalRoomVolume, ThermalState, this);
+	}
+}
+
+void AThermalRoomVolume::BuildGrid()
+{
+	const FVector Extent = Box->GetUnscaledBoxExtent();
+	const FVector Scale = GetActorScale3D().GetAbs();
+	const FVector SizeCm = 2.0f * Extent * Scale;
+
+	const float MaxAxis = FMath::Max(SizeCm.GetMax(), 1.0f);
+	const float VoxelCm = FMath::Max(VoxelSizeCm, MaxAxis / MaxVoxelsPerAxis);
+
+	Dims.X = FMath::Clamp(FMath::CeilToInt32(SizeCm.X / VoxelCm), 1, MaxVoxelsPerAxis);
+	Dims.Y = FMath::Clamp(FMath::CeilToInt32(SizeCm.Y / VoxelCm), 1, MaxVoxelsPerAxis);
+	Dims.Z = FMath::Clamp(FMath::CeilToInt32(SizeCm.Z / VoxelCm), 1, MaxVoxelsPerAxis);
+
+	// voxels are laid out in the box's local space so a rotated room still gets an aligned grid
+	LocalMin = -Extent;
+	VoxelSize = FVector(2.0f * Extent.X / Dims.X, 2.0f * Extent.Y / Dims.Y, 2.0f * Extent.Z / Dims.Z);
+
+	const int32 NumVoxels = Dims.X * Dims.Y * Dims.Z;
+	Temperatures.Init(AmbientTemperature, NumVoxels);
+	NextTemperatures.Init(AmbientTemperature, NumVoxels);
+	Diffusivities.Init(AirDiffusivity, NumVoxels);
+	MaxDiffusivity = AirDiffusivity;
+
+	if (!bDetectSolids) return;
+
+	const FTransform& BoxTransform = Box->GetComponentTransform();
+	const FCollisionShape Probe = FCollisionShape::MakeBox(0.25f * VoxelSize * Scale);
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(ThermalRoomSolids), false, this);
+
+	for (int32 Z = 0; Z < Dims.Z; ++Z)
+	{
+		for (int32 Y = 0; Y < Dims.Y; ++Y)
+		{
+			for (int32 X = 0; X < Dims.X; ++X)
+			{
+				const FVector LocalCenter = LocalMin + VoxelSize * FVector(X + 0.5f, Y + 0.5f, Z + 0.5f);
+				const FVector WorldCenter = BoxTransform.TransformPosition(LocalCenter);
+
+				if (GetWorld()->OverlapAnyTestByChannel(WorldCenter, BoxTransform.GetRotation(), ECC_WorldStatic, Probe, Params))
+				{
+					Diffusivities[GetVoxelIndex(X, Y, Z)] = SolidDiffusivity;
+					MaxDiffusivity = FMath::Max(MaxDiffusivity, SolidDiffusivity);
+				}
+			}
+		}
+	}
+}
+
+bool AThermalRoomVolume::WorldToVoxel(const FVector& WorldLocation, FIntVector& OutVoxel) const
+{
+	if (Temperatures.Num() == 0) return false;
+
+	const FVector Local = Box->GetComponentTransform().InverseTransformPosition(WorldLocation) - LocalMin;
+
+	OutVoxel.X = FMath::FloorToInt32(Local.X / VoxelSize.X);
+	OutVoxel.Y = FMath::FloorToInt32(Local.Y / VoxelSize.Y);
+	OutVoxel.Z = FMath::FloorToInt32(Local.Z / VoxelSize.Z);
+
+	return OutVoxel.X >= 0 && OutVoxel.X < Dims.X
+		&& OutVoxel.Y >= 0 && OutVoxel.Y < Dims.Y
+		&& OutVoxel.Z >= 0 && OutVoxel.Z < Dims.Z;
+}
+
+void AThermalRoomVolume::InjectSource(const FVector& WorldLocation, float SourceTemperature)
+{
+	FIntVector Voxel;
+	if (!WorldToVoxel(WorldLocation, Voxel)) return;
+
+	float& Temperature = Temperatures[GetVoxelIndex(Voxel.X, Voxel.Y, Voxel.Z)];
+	Temperature = FMath::Max(Temperature, SourceTemperature);
+}
+
+bool AThermalRoomVolume::SampleTemperature(const FVector& WorldLocation, float& OutTemperature) const
+{
+	FIntVector Voxel;
+	if (!WorldToVoxel(WorldLocation, Voxel)) return false;
+
+	OutTemperature = Temperatures[GetVoxelIndex(Voxel.X, Voxel.Y, Voxel.Z)];
+	return true;
+}
+
+bool AThermalRoomVolume::SampleExcessTemperature(const FVector& WorldLocation, float& OutExcess) const
+{
+	float Temperature;
+	if (!SampleTemperature(WorldLocation, Temperature)) return false;
+
+	OutExcess = FMath::Max(Temperature - AmbientTemperature, 0.0f);
+	return true;
+}
+
+float AThermalRoomVolume::GetTemperatureAt(const FVector& WorldLocation) const
+{
+	float Temperature = AmbientTemperature;
+	SampleTemperature(WorldLocation, Temperature);
+	return Temperature;
+}
+
+void AThermalRoomVolume::StepConduction(float DeltaTime)
+{
+	const int32 NumVoxels = Temperatures.Num();
+	if (NumVoxels == 0 || DeltaTime <= 0.0f) return;
+
+	const FVector VoxelM = VoxelSize * GetActorScale3D().GetAbs() / 100.0f;
+	const FVector InvDx2(1.0f / FMath::Square(VoxelM.X), 1.0f / FMath::Square(VoxelM.Y), 1.0f / FMath::Square(VoxelM.Z));
+
+	// explicit diffusion is stable while dt * D * sum(1/dx^2) <= 1/2
+	const float SimDeltaTime = DeltaTime * SimTimeScale;
+	const float StableStep = MaxDiffusivity > 0.0f ? 0.45f / (MaxDiffusivity * (InvDx2.X + InvDx2.Y + InvDx2.Z)) : SimDeltaTime;
+	const int32 NumSubsteps = FMath::Clamp(FMath::CeilToInt32(SimDeltaTime / StableStep), 1, MaxSubsteps);
+	const float SubstepTime = FMath::Min(SimDeltaTime / NumSubsteps, StableStep);
+
+	const float AmbientBlend = FMath::Clamp(AmbientLossRate * SubstepTime, 0.0f, 1.0f);
+	const EParallelForFlags Flags = NumVoxels < MinVoxelsForParallel ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None;
+
+	const int32 StrideY = Dims.X;
+	const int32 StrideZ = Dims.X * Dims.Y;
+
+	for (int32 Substep = 0; Substep < NumSubsteps; ++Substep)
+	{
+		const float* Current = Temperatures.GetData();
+		const float* Diffusivity = Diffusivities.GetData();
+		float* Next = NextTemperatures.GetData();
+
+		// each Z slab reads the current buffer and writes only its own voxels in the next one
+		ParallelFor(Dims.Z, [&](int32 Z)
+		{
+			for (int32 Y = 0; Y < Dims.Y; ++Y)
+			{
+				for (int32 X = 0; X < Dims.X; ++X)
+				{
+					const int32 i = GetVoxelIndex(X, Y, Z);
+					const float T = Current[i];
+					const float D = Diffusivity[i];
+
+					// harmonic mean of the two diffusivities across each face, walls are insulated
+					auto Flux = [&](int32 n, float InvDx2Axis)
+					{
+						const float Dn = Diffusivity[n];
+						const float Face = (D + Dn) > 0.0f ? (2.0f * D * Dn) / (D + Dn) : 0.0f;
+						return Face * (Current[n] - T) * InvDx2Axis;
+					};
+
+					float Laplacian = 0.0f;
+					if (X > 0)           Laplacian += Flux(i - 1, InvDx2.X);
+					if (X < Dims.X - 1)  Laplacian += Flux(i + 1, InvDx2.X);
+					if (Y > 0)           Laplacian += Flux(i - StrideY, InvDx2.Y);
+					if (Y < Dims.Y - 1)  Laplacian += Flux(i + StrideY, InvDx2.Y);
+					if (Z > 0)           Laplacian += Flux(i - StrideZ, InvDx2.Z);
+					if (Z < Dims.Z - 1)  Laplacian += Flux(i + StrideZ, InvDx2.Z);
+
+					const float Diffused = T + SubstepTime * Laplacian;
+					Next[i] = Diffused + (AmbientTemperature - Diffused) * AmbientBlend;
+				}
+			}
+		}, Flags);
+
+		Swap(Temperatures, NextTemperatures);
+	}
+}
@@ -0,0 +1,144 @@
+// ThermalRoomVolume.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ThermalReplication.h"
+#include "ThermalRoomVolume.generated.h"
+
+class UBoxComponent;
+
+/**
+ *  Optional voxel temperature grid for a puzzle room.
+ *  Heat sources inside the box pin their cell to their own temperature, the grid diffuses heat through
+ *  air and solid geometry with an explicit step, and heat receivers inside the box sample it for conduction.
+ *  The diffusion step is split into Z slabs and run with ParallelFor.
+ *  In networked games the room also replicates the quantized thermal state of the level actors inside it.
+ *  With bConduction off the room only replicates: no grid is built and receivers inside it are simulated as if it were not there.
+ */
+UCLASS()
+class MATERIAL_API AThermalRoomVolume : public AActor
+{
+	GENERATED_BODY()
+
+	/** Extent of the grid */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Components, meta = (AllowPrivateAccess = "true"))
+	UBoxComponent* Box;
+
+public:
+
+	AThermalRoomVolume();
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Builds and steps the voxel grid and couples receivers inside the box to it. Off for rooms placed only for replication */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Thermal|Conduction")
+	bool bConduction = true;
+
+	/** Edge length of one voxel */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Thermal|Grid", meta=(ClampMin=10, Units="cm", EditCondition="bConduction"))
+	float VoxelSizeCm = 50.0f;
+
+	/** Upper bound on voxels per axis, the voxel size grows if the box would exceed it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Thermal|Grid", meta=(ClampMin=2, ClampMax=256, EditCondition="bConduction"))
+	int32 MaxVoxelsPerAxis = 64;
+
+	/** Starting temperature of every voxel and the temperature the room relaxes back to */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Thermal|Grid")
+	float AmbientTemperature = 20.0f;
+
+	/** Effective diffusivity of air, including convective mixing, in m^2/s */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Thermal|Conduction", meta=(ClampMin=0, EditCondition="bConduction"))
+	float AirDiffusivity = 0.01f;
+
+	/** Diffusivity of voxels overlapping static geometry (floors, metal blocks), in m^2/s */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Thermal|Conduction", meta=(ClampMin=0, EditCondition="bConduction"))
+	float SolidDiffusivity = 0.05f;
+
+	/** Marks voxels that overlap WorldStatic geometry as solid when the grid is built */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Thermal|Conduction", meta=(EditCondition="bConduction"))
+	bool bDetectSolids = true;
+
+	/** Fraction of the difference to AmbientTemperature lost per simulated second */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Thermal|Conduction", meta=(ClampMin=0, EditCondition="bConduction"))
+	float AmbientLossRate = 0.002f;
+
+	/** Simulated seconds per real second */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Thermal|Conduction", meta=(ClampMin=0, EditCondition="bConduction"))
+	float SimTimeScale = 60.0f;
+
+	/** Cap on stability substeps per update. When hit, the grid runs slower than SimTimeScale instead of blowing up */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Thermal|Conduction", meta=(ClampMin=1, EditCondition="bConduction"))
+	int32 MaxSubsteps = 8;
+
+	/** Heat transfer coefficient between a voxel and a receiver inside it, in W/(m^2 K), applied to the voxel's excess over AmbientTemperature */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Thermal|Receivers", meta=(ClampMin=0, EditCondition="bConduction"))
+	float HeatTransferCoefficient = 25.0f;
+
+	/** Grids with fewer voxels than this are stepped on the game thread */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Thermal|Grid", meta=(ClampMin=0, EditCondition="bConduction"))
+	int32 MinVoxelsForParallel = 4096;
+
+	/** Sends the melt, form, temperature and magnet state of the level actors inside the box from the server to clients */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Thermal|Replication")
+	bool bReplicateThermalState = true;
+
+	/** Seconds between server checks for changed state. Unchanged entries are never sent */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Thermal|Replication", meta=(ClampMin=0.02, Units="s", EditCondition="bReplicateThermalState"))
+	float ReplicationInterval = 0.1f;
+
+	/** Pins the voxel containing WorldLocation to at least SourceTemperature for the next step */
+	void InjectSource(const FVector& WorldLocation, float SourceTemperature);
+
+	/** Advances diffusion by DeltaTime real seconds */
+	void StepConduction(float DeltaTime);
+
+	/** Returns false if WorldLocation is outside the grid */
+	bool SampleTemperature(const FVector& WorldLocation, float& OutTemperature) const;
+
+	/** Degrees above AmbientTemperature at the location, never negative. Returns false if WorldLocation is outside the grid */
+	bool SampleExcessTemperature(const FVector& WorldLocation, float& OutExcess) const;
+
+	/** Returns the voxel temperature at the location, or AmbientTemperature outside the grid */
+	UFUNCTION(BlueprintPure, Category="Thermal")
+	float GetTemperatureAt(const FVector& WorldLocation) const;
+
+private:
+
+	void BuildGrid();
+
+	/** Adds an entry for every stably named puzzle actor inside the box. Server only */
+	void GatherReplicatedActors();
+	void CaptureThermalState();
+	bool WorldToVoxel(const FVector& WorldLocation, FIntVector& OutVoxel) const;
+
+	int32 GetVoxelIndex(int32 X, int32 Y, int32 Z) const
+	{
+		return X + Dims.X * (Y + Dims.Y * Z);
+	}
+
+	FIntVector Dims = FIntVector::ZeroValue;
+	FVector VoxelSize = FVector::ZeroVector;
+	FVector LocalMin = FVector::ZeroVector;
+
+	/** Double-buffered voxel temperatures, swapped after every substep */
+	TArray<float> Temperatures;
+	TArray<float> NextTemperatures;
+
+	/** Per-voxel diffusivity, air or solid */
+	TArray<float> Diffusivities;
+	float MaxDiffusivity = 0.0f;
+
+	UPROPERTY(Replicated)
+	FThermalRepArray ThermalState;
+
+	FTimerHandle ReplicationTimer;
+};
@@ -0,0 +1,262 @@
+// ThermalTextureSubsystem.cpp
+
+#include "ThermalTextureSubsystem.h"
+
+#include "Engine/World.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "GameFramework/PlayerController.h"
+#include "Materials/MaterialParameterCollection.h"
+#include "Materials/MaterialParameterCollectionInstance.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+#include "HeatSimSettings.h"
+#include "ThermalRoomVolume.h"
+#include "MaterialSimStats.h"
+
+bool UThermalTextureSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UThermalTextureSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	const UHeatSimSettings* Settings = GetDefault<UHeatSimSettings>();
+	RenderTarget = Settings->ThermalRenderTarget.LoadSynchronous();
+	ParameterCollection = Settings->ThermalParameterCollection.LoadSynchronous();
+	if (!RenderTarget) return;
+
+	Size = FIntPoint(FMath::Max(RenderTarget->SizeX, 1), FMath::Max(RenderTarget->SizeY, 1));
+	CellSize = Settings->ThermalCellSizeCm;
+
+	// half floats hold degrees C with room to spare, and are half the upload of R32F
+	RenderTarget->InitCustomFormat(Size.X, Size.Y, PF_R16F, true);
+
+	Cells.Init(Settings->ThermalAmbientTemperature, Size.X * Size.Y);
+	UploadedCells.Init(FFloat16(Settings->ThermalAmbientTemperature), Size.X * Size.Y);
+	bFullUpload = true;
+}
+
+void UThermalTextureSubsystem::Deinitialize()
+{
+	RenderTarget = nullptr;
+	ParameterCollection = nullptr;
+	Cells.Empty();
+	UploadedCells.Empty();
+	Points.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UThermalTextureSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UThermalTextureSubsystem, STATGROUP_Tickables);
+}
+
+void UThermalTextureSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!RenderTarget) return;
+
+	UpdateAccumulator += DeltaTime;
+	if (UpdateAccumulator < GetDefault<UHeatSimSettings>()->ThermalUpdateInterval) return;
+	UpdateAccumulator = 0.0f;
+
+	MATERIALSIM_SCOPE(ThermalTexture_Update);
+
+	UpdateOrigin();
+	BuildCells();
+	UploadDirtyCells();
+}
+
+bool UThermalTextureSubsystem::UpdateOrigin()
+{
+	const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	if (!PC) return false;
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	ViewZ = static_cast<float>(ViewLocation.Z);
+
+	const FVector2D WorldSize = FVector2D(Size) * CellSize;
+	const FVector2D View(ViewLocation.X, ViewLocation.Y);
+	const FVector2D FromCenter = View - (Origin + WorldSize * 0.5);
+
+	// moving the grid changes every cell, so it only jumps once the view is out of the middle half
+	if (!bFullUpload && FMath::Abs(FromCenter.X) < WorldSize.X * 0.25 && FMath::Abs(FromCenter.Y) < WorldSize.Y * 0.25)
+	{
+		return false;
+	}
+
+	// snapped to whole cells so the grid stays world aligned
+	const FVector2D Corner = View - WorldSize * 0.5;
+	Origin = FVector2D(FMath::FloorToDouble(Corner.X / CellSize) * CellSize, FMath::FloorToDouble(Corner.Y / CellSize) * CellSize);
+	bFullUpload = true;
+
+	if (ParameterCollection)
+	{
+		if (UMaterialParameterCollectionInstance* Instance = GetWorld()->GetParameterCollectionInstance(ParameterCollection))
+		{
+			const FLinearColor Placement(Origin.X, Origin.Y, 1.0 / WorldSize.X, 1.0 / WorldSize.Y);
+			Instance->SetVectorParameterValue(GetDefault<UHeatSimSettings>()->ThermalOriginParamName, Placement);
+		}
+	}
+	return true;
+}
+
+void UThermalTextureSubsystem::BuildCells()
+{
+	const float Ambient = GetDefault<UHeatSimSettings>()->ThermalAmbientTemperature;
+	for (float& Cell : Cells)
+	{
+		Cell = Ambient;
+	}
+
+	const UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>();
+	if (!HeatSim) return;
+
+	// room air first, objects are drawn on top of it
+	for (const TWeakObjectPtr<AThermalRoomVolume>& Room : HeatSim->GetRooms())
+	{
+		if (Room.IsValid())
+		{
+			SplatRoom(*Room);
+		}
+	}
+
+	Points.Reset();
+	HeatSim->GatherThermalPoints(Points);
+	for (const FHeatThermalPoint& Point : Points)
+	{
+		SplatPoint(Point);
+	}
+}
+
+void UThermalTextureSubsystem::SplatRoom(const AThermalRoomVolume& Room)
+{
+	const FBox Bounds = Room.GetComponentsBoundingBox(true);
+	const float SampleZ = FMath::Clamp(ViewZ, static_cast<float>(Bounds.Min.Z), static_cast<float>(Bounds.Max.Z));
+
+	const int32 MinX = FMath::Max(FMath::FloorToInt32((Bounds.Min.X - Origin.X) / CellSize), 0);
+	const int32 MinY = FMath::Max(FMath::FloorToInt32((Bounds.Min.Y - Origin.Y) / CellSize), 0);
+	const int32 MaxX = FMath::Min(FMath::FloorToInt32((Bounds.Max.X - Origin.X) / CellSize), Size.X - 1);
+	const int32 MaxY = FMath::Min(FMath::FloorToInt32((Bounds.Max.Y - Origin.Y) / CellSize), Size.Y - 1);
+
+	for (int32 Y = MinY; Y <= MaxY; ++Y)
+	{
+		for (int32 X = MinX; X <= MaxX; ++X)
+		{
+			const FVector Center(Origin.X + (X + 0.5) * CellSize, Origin.Y + (Y + 0.5) * CellSize, SampleZ);
+
+			float VoxelTemperature;
+			if (Room.SampleTemperature(Center, VoxelTemperature))
+			{
+				Cells[X + Y * Size.X] = VoxelTemperature;
+			}
+		}
+	}
+}
+
+void UThermalTextureSubsystem::SplatPoint(const FHeatThermalPoint& Point)
+{
+	const double LocalX = (Point.Location.X - Origin.X) / CellSize;
+	const double LocalY = (Point.Location.Y - Origin.Y) / CellSize;
+
+	// receivers only mark the cell they sit in
+	if (!Point.bSource)
+	{
+		const int32 X = FMath::FloorToInt32(LocalX);
+		const int32 Y = FMath::FloorToInt32(LocalY);
+		if (X >= 0 && X < Size.X && Y >= 0 && Y < Size.Y)
+		{
+			float& Cell = Cells[X + Y * Size.X];
+			Cell = FMath::Min(Cell, Point.TemperatureC);
+		}
+		return;
+	}
+
+	const float RadiusCells = FMath::Max(GetDefault<UHeatSimSettings>()->ThermalSourceRadiusCm / CellSize, 0.5f);
+
+	const int32 MinX = FMath::Max(FMath::FloorToInt32(LocalX - RadiusCells), 0);
+	const int32 MinY = FMath::Max(FMath::FloorToInt32(LocalY - RadiusCells), 0);
+	const int32 MaxX = FMath::Min(FMath::FloorToInt32(LocalX + RadiusCells), Size.X - 1);
+	const int32 MaxY = FMath::Min(FMath::FloorToInt32(LocalY + RadiusCells), Size.Y - 1);
+
+	for (int32 Y = MinY; Y <= MaxY; ++Y)
+	{
+		for (int32 X = MinX; X <= MaxX; ++X)
+		{
+			const float Dist = static_cast<float>(FVector2D::Distance(FVector2D(X + 0.5, Y + 0.5), FVector2D(LocalX, LocalY)));
+			if (Dist > RadiusCells) continue;
+
+			float& Cell = Cells[X + Y * Size.X];
+			Cell = FMath::Max(Cell, FMath::Lerp(Cell, Point.TemperatureC, 1.0f - Dist / RadiusCells));
+		}
+	}
+}
+
+void UThermalTextureSubsystem::UploadDirtyCells()
+{
+	FTextureRenderTargetResource* Resource = RenderTarget->GameThread_GetRenderTargetResource();
+	if (!Resource) return;
+
+	// one region per row, spanning the first to the last changed cell of that row
+	TArray<FFloat16> Packed;
+	TArray<FUpdateTextureRegion2D> Regions;
+	TArray<int32> Offsets;
+
+	for (int32 Y = 0; Y < Size.Y; ++Y)
+	{
+		int32 FirstX = INDEX_NONE;
+		int32 LastX = INDEX_NONE;
+
+		for (int32 X = 0; X < Size.X; ++X)
+		{
+			const int32 i = X + Y * Size.X;
+			const FFloat16 Value(Cells[i]);
+			if (!bFullUpload && Value.Encoded == UploadedCells[i].Encoded) continue;
+
+			UploadedCells[i] = Value;
+			FirstX = FirstX == INDEX_NONE ? X : FirstX;
+			LastX = X;
+		}
+
+		if (FirstX == INDEX_NONE) continue;
+
+		const int32 Width = LastX - FirstX + 1;
+		Offsets.Add(Packed.Num());
+		Packed.Append(&UploadedCells[FirstX + Y * Size.X], Width);
+		Regions.Add(FUpdateTextureRegion2D(FirstX, Y, 0, 0, Width, 1));
+	}
+
+	bFullUpload = false;
+	if (Regions.Num() == 0) return;
+
+	ENQUEUE_RENDER_COMMAND(UpdateThermalTexture)(
+		[Resource, Packed = MoveTemp(Packed), Regions = MoveTemp(Regions), Offsets = MoveTemp(Offsets)](FRHICommandListImmediate& RHICmdList)
+		{
+			FRHITexture* Texture = Resource->GetRenderTargetTexture();
+			if (!Texture) return;
+
+			for (int32 i = 0; i < Regions.Num(); ++i)
+			{
+				const uint8* Data = reinterpret_cast<const uint8*>(Packed.GetData() + Offsets[i]);
+				RHICmdList.UpdateTexture2D(Texture, 0, Regions[i], Regions[i].Width * sizeof(FFloat16), Data);
+			}
+		});
+}
+
+float UThermalTextureSubsystem::GetCellTemperature(const FVector& WorldLocation) const
+{
+	const int32 X = FMath::FloorToInt32((WorldLocation.X - Origin.X) / CellSize);
+	const int32 Y = FMath::FloorToInt32((WorldLocation.Y - Origin.Y) / CellSize);
+
+	if (X < 0 || X >= Size.X || Y < 0 || Y >= Size.Y || Cells.Num() == 0)
+	{
+		return GetDefault<UHeatSimSettings>()->ThermalAmbientTemperature;
+	}
+	return Cells[X + Y * Size.X];
+}
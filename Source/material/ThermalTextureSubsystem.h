@@ -0,0 +1,65 @@
+// ThermalTextureSubsystem.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Math/Float16.h"
+#include "HeatSimSubsystem.h"
+#include "ThermalTextureSubsystem.generated.h"
+
+class UTextureRenderTarget2D;
+class UMaterialParameterCollection;
+
+/**
+ *  Writes the live thermal state into one world-aligned, top-down temperature texture (see UHeatSimSettings),
+ *  so thermal vision samples a single texture instead of per-object material parameters.
+ *  The grid follows the player view in coarse jumps; between jumps only the cells that changed are uploaded.
+ */
+UCLASS()
+class MATERIAL_API UThermalTextureSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Grid temperature at a world location, or the ambient temperature outside the grid */
+	UFUNCTION(BlueprintPure, Category="Thermal")
+	float GetCellTemperature(const FVector& WorldLocation) const;
+
+private:
+
+	/** Moves the grid when the view has left its middle half. Returns true if it moved */
+	bool UpdateOrigin();
+
+	void BuildCells();
+	void UploadDirtyCells();
+
+	void SplatPoint(const FHeatThermalPoint& Point);
+	void SplatRoom(const AThermalRoomVolume& Room);
+
+	UPROPERTY(Transient)
+	TObjectPtr<UTextureRenderTarget2D> RenderTarget;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UMaterialParameterCollection> ParameterCollection;
+
+	FIntPoint Size = FIntPoint::ZeroValue;
+	float CellSize = 50.0f;
+	FVector2D Origin = FVector2D::ZeroVector;
+	float ViewZ = 0.0f;
+	bool bFullUpload = true;
+
+	/** Temperatures built this update and the ones currently on the GPU, in degrees C */
+	TArray<float> Cells;
+	TArray<FFloat16> UploadedCells;
+
+	TArray<FHeatThermalPoint> Points;
+	float UpdateAccumulator = 0.0f;
+};
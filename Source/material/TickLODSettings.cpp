@@ -0,0 +1,39 @@
+// TickLODSettings.cpp
+
+#include "TickLODSettings.h"
+
+UTickLODSettings::UTickLODSettings()
+{
+	CategoryName = TEXT("Game");
+	SectionName = TEXT("Tick LOD");
+
+	DefaultTiers.Add({ 2000.0f, 0.0f });
+	DefaultTiers.Add({ 5000.0f, 0.1f });
+	DefaultTiers.Add({ 10000.0f, 0.5f });
+}
+
+const TArray<FTickLODTier>& UTickLODSettings::GetTiersForClass(const UClass* ActorClass) const
+{
+	return GetTiers(FindClassTiersIndex(ActorClass));
+}
+
+int32 UTickLODSettings::FindClassTiersIndex(const UClass* ActorClass) const
+{
+	int32 Best = INDEX_NONE;
+	const UClass* BestClass = nullptr;
+
+	for (int32 i = 0; i < ClassTiers.Num(); ++i)
+	{
+		const FTickLODClassTiers& Entry = ClassTiers[i];
+		const UClass* EntryClass = Entry.ActorClass.Get();
+		if (!EntryClass || Entry.Tiers.Num() == 0 || !ActorClass || !ActorClass->IsChildOf(EntryClass)) continue;
+
+		if (!BestClass || EntryClass->IsChildOf(BestClass))
+		{
+			Best = i;
+			BestClass = EntryClass;
+		}
+	}
+
+	return Best;
+}
@@ -0,0 +1,75 @@
+// TickLODSettings.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "TickLODSettings.generated.h"
+
+/** One distance band and the update interval used inside it */
+USTRUCT(BlueprintType)
+struct FTickLODTier
+{
+	GENERATED_BODY()
+
+	/** Actors closer than this to the nearest player view use this tier */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Tick LOD", meta=(ClampMin=0, Units="cm"))
+	float MaxDistance = 0.0f;
+
+	/** Seconds between updates, 0 updates every frame */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Tick LOD", meta=(ClampMin=0, Units="s"))
+	float Interval = 0.0f;
+};
+
+/** Tier list for one actor class, sorted by MaxDistance */
+USTRUCT(BlueprintType)
+struct FTickLODClassTiers
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Tick LOD")
+	TSoftClassPtr<AActor> ActorClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Tick LOD")
+	TArray<FTickLODTier> Tiers;
+};
+
+/**
+ *  Update rate tiers for heat and magnet actors, found under Project Settings > Game > Tick LOD.
+ */
+UCLASS(config=Game, defaultconfig, meta=(DisplayName="Tick LOD"))
+class MATERIAL_API UTickLODSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	UTickLODSettings();
+
+	/** Returns the tiers of the most derived class entry matching ActorClass, or DefaultTiers */
+	const TArray<FTickLODTier>& GetTiersForClass(const UClass* ActorClass) const;
+
+	/** Index into ClassTiers of the most derived entry matching ActorClass, or INDEX_NONE for DefaultTiers */
+	int32 FindClassTiersIndex(const UClass* ActorClass) const;
+
+	/** Tiers of the ClassTiers entry at ClassTiersIndex, or DefaultTiers for INDEX_NONE */
+	const TArray<FTickLODTier>& GetTiers(int32 ClassTiersIndex) const
+	{
+		return ClassTiers.IsValidIndex(ClassTiersIndex) ? ClassTiers[ClassTiersIndex].Tiers : DefaultTiers;
+	}
+
+	/** Seconds between two significance passes over the same actor */
+	UPROPERTY(config, EditAnywhere, Category="Tick LOD", meta=(ClampMin=0, Units="s"))
+	float EvaluationInterval = 0.25f;
+
+	/** Actors not rendered within this time count as off-screen and drop one tier */
+	UPROPERTY(config, EditAnywhere, Category="Tick LOD", meta=(ClampMin=0, Units="s"))
+	float OffscreenGraceTime = 0.5f;
+
+	/** Used for every class without its own entry. Beyond the last MaxDistance the last tier applies */
+	UPROPERTY(config, EditAnywhere, Category="Tick LOD")
+	TArray<FTickLODTier> DefaultTiers;
+
+	UPROPERTY(config, EditAnywhere, Category="Tick LOD")
+	TArray<FTickLODClassTiers> ClassTiers;
+};
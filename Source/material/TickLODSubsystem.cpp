@@ -0,0 +1,151 @@
+// TickLODSubsystem.cpp
+
+#include "TickLODSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "MaterialSimStats.h"
+
+bool UTickLODSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTickLODSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	EntryIndices.Empty();
+	NextEntry = 0;
+
+	Super::Deinitialize();
+}
+
+TStatId UTickLODSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTickLODSubsystem, STATGROUP_Tickables);
+}
+
+void UTickLODSubsystem::RegisterActor(AActor* Actor, FOnTickLODChanged OnChanged)
+{
+	if (!Actor) return;
+
+	UnregisterActor(Actor);
+
+	EntryIndices.Add(Actor, Entries.Num());
+
+	FEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Actor = Actor;
+	Entry.OnChanged = MoveTemp(OnChanged);
+	Entry.ClassTiersIndex = GetDefault<UTickLODSettings>()->FindClassTiersIndex(Actor->GetClass());
+}
+
+void UTickLODSubsystem::UnregisterActor(const AActor* Actor)
+{
+	int32 Index;
+	if (EntryIndices.RemoveAndCopyValue(Actor, Index))
+	{
+		RemoveEntryAt(Index);
+	}
+}
+
+void UTickLODSubsystem::RemoveEntryAt(int32 Index)
+{
+	EntryIndices.Remove(Entries[Index].Actor);
+	Entries.RemoveAtSwap(Index, EAllowShrinking::No);
+
+	if (Entries.IsValidIndex(Index))
+	{
+		EntryIndices.Add(Entries[Index].Actor, Index);
+	}
+}
+
+float UTickLODSubsystem::EvaluateInterval(const AActor* Actor, const TArray<FTickLODTier>& Tiers, TConstArrayView<FVector> ViewLocations) const
+{
+	if (Tiers.Num() == 0) return 0.0f;
+
+	float MinDistSq = TNumericLimits<float>::Max();
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		MinDistSq = FMath::Min(MinDistSq, static_cast<float>(FVector::DistSquared(ViewLocation, Actor->GetActorLocation())));
+	}
+
+	int32 Tier = Tiers.Num() - 1;
+	for (int32 i = 0; i < Tiers.Num(); ++i)
+	{
+		if (MinDistSq <= FMath::Square(Tiers[i].MaxDistance))
+		{
+			Tier = i;
+			break;
+		}
+	}
+
+	// off-screen actors are one tier coarser
+	if (!Actor->WasRecentlyRendered(GetDefault<UTickLODSettings>()->OffscreenGraceTime))
+	{
+		Tier = FMath::Min(Tier + 1, Tiers.Num() - 1);
+	}
+
+	return Tiers[Tier].Interval;
+}
+
+void UTickLODSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Entries.Num() == 0) return;
+
+	MATERIALSIM_SCOPE(TickLOD_Tick);
+
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PC = It->Get())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PC->GetPlayerViewPoint(Location, Rotation);
+			ViewLocations.Add(Location);
+		}
+	}
+
+	// without a viewer there is nothing to rank against, keep the current tiers
+	if (ViewLocations.Num() == 0) return;
+
+	const UTickLODSettings* Settings = GetDefault<UTickLODSettings>();
+
+	int32 NumToEvaluate = Entries.Num();
+	if (Settings->EvaluationInterval > 0.0f)
+	{
+		SliceAccumulator += Entries.Num() * DeltaTime / Settings->EvaluationInterval;
+		NumToEvaluate = FMath::Min(FMath::FloorToInt32(SliceAccumulator), Entries.Num());
+		SliceAccumulator -= NumToEvaluate;
+	}
+
+	for (int32 Count = 0; Count < NumToEvaluate && Entries.Num() > 0; ++Count)
+	{
+		if (NextEntry >= Entries.Num())
+		{
+			NextEntry = 0;
+		}
+
+		FEntry& Entry = Entries[NextEntry];
+		const AActor* Actor = Entry.Actor.ResolveObjectPtr();
+		if (!Actor)
+		{
+			RemoveEntryAt(NextEntry);
+			continue;
+		}
+
+		const float Interval = EvaluateInterval(Actor, Settings->GetTiers(Entry.ClassTiersIndex), ViewLocations);
+		++NextEntry;
+
+		if (Interval != Entry.Interval)
+		{
+			Entry.Interval = Interval;
+
+			// the callback may register or unregister actors, so it runs on a copy
+			const FOnTickLODChanged OnChanged = Entry.OnChanged;
+			OnChanged.ExecuteIfBound(Interval);
+		}
+	}
+}
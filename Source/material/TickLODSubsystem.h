@@ -0,0 +1,54 @@
+// TickLODSubsystem.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TickLODSettings.h"
+#include "TickLODSubsystem.generated.h"
+
+/** Receives the new update interval in seconds, 0 meaning every frame */
+DECLARE_DELEGATE_OneParam(FOnTickLODChanged, float);
+
+/**
+ *  Lightweight significance pass for heat and magnet actors.
+ *  Registered actors are binned into the distance tiers from UTickLODSettings, based on the nearest
+ *  player view and whether they were rendered recently. The owner is told whenever its tier changes.
+ */
+UCLASS()
+class MATERIAL_API UTickLODSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Starts tracking the actor. OnChanged fires with the first evaluated interval and on every tier change */
+	void RegisterActor(AActor* Actor, FOnTickLODChanged OnChanged);
+	void UnregisterActor(const AActor* Actor);
+
+private:
+
+	float EvaluateInterval(const AActor* Actor, const TArray<FTickLODTier>& Tiers, TConstArrayView<FVector> ViewLocations) const;
+	void RemoveEntryAt(int32 Index);
+
+	struct FEntry
+	{
+		TObjectKey<AActor> Actor;
+		FOnTickLODChanged OnChanged;
+
+		/** Into UTickLODSettings::ClassTiers, INDEX_NONE for the default tiers */
+		int32 ClassTiersIndex = INDEX_NONE;
+		float Interval = -1.0f;
+	};
+	TArray<FEntry> Entries;
+	TMap<TObjectKey<AActor>, int32> EntryIndices;
+
+	/** Round-robin position, each tick evaluates a slice so every actor is revisited once per EvaluationInterval */
+	int32 NextEntry = 0;
+	float SliceAccumulator = 0.0f;
+};
@@ -6,10 +6,15 @@
 #include "PhysicalMaterials/PhysicalMaterial.h"
 #include "Engine/Engine.h"
 #include "Temperature.h"
+#include "HeatSimSubsystem.h"
+#include "HeatPhaseSubsystem.h"
+#include "MaterialSimStats.h"
+#include "HeatTelemetry.h"
+#include "ThermalMeshData.h"
 
 ATransformation_actor::ATransformation_actor()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	MeshComp = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("MeshComp"));
 	SetRootComponent(MeshComp);
@@ -22,6 +27,7 @@ ATransformation_actor::ATransformation_actor()
 void ATransformation_actor::BeginPlay()
 {
 	Super::BeginPlay();
+	SpawnForm = CurrentForm;
 	SetForm(CurrentForm);
 }
 
@@ -42,79 +48,79 @@ void ATransformation_actor::OnConstruction(const FTransform& Transform)
 	}
 }
 
-void ATransformation_actor::Tick(float DeltaTime)
+void ATransformation_actor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	UnregisterHeatReceiver();
 
-	if (CurrentForm != EBlockForm::Ice) return;
-	if (!bHeating || !CurrentFire || !MeshComp) return;
-	if (MeltAlpha >= 1.0f) return;
-
-	const float DistCm = FVector::Dist(CurrentFire->GetActorLocation(), GetActorLocation());
-	if (CurrentFire->MaxHeatDistance > 0.0f && DistCm > CurrentFire->MaxHeatDistance) return;
-
-	const float DistM = FMath::Max(DistCm / 100.0f, 0.05f);
-
-	const float PtotalW = CurrentFire->GetTotalRadiantPowerW();
-	float HeatFluxWm2 = PtotalW / (4.0f * PI * DistM * DistM);
-	float ReceivedPowerW = HeatFluxWm2 * EffectiveAreaM2;
-
-	if (CurrentFire->MaxHeatDistance > 0.0f)
-	{
-		const float Fade = FMath::Clamp(1.0f - (DistCm / CurrentFire->MaxHeatDistance), 0.0f, 1.0f);
-		ReceivedPowerW *= Fade;
-	}
+	Super::EndPlay(EndPlayReason);
+}
 
-	if (ReceivedPowerW <= 0.0f) return;
+void ATransformation_actor::ApplyHeatSimState(float NewEnergyJ, float NewMeltAlpha, float ReceivedPowerW, float DistCm, float DeltaTime)
+{
+	if (CurrentForm != EBlockForm::Ice || !MeshComp) return;
 
-	EnergyAccumJ += ReceivedPowerW * DeltaTime * FMath::Max(SimTimeScale, 0.0f);
-	MeltAlpha = FMath::Clamp(EnergyAccumJ / FMath::Max(TotalMeltEnergyJ, 1.0f), 0.0f, 1.0f);
+	EnergyAccumJ = NewEnergyJ;
+	MeltAlpha = NewMeltAlpha;
 
 	ApplyIceMeltVisual(MeltAlpha);
 
-	if (bDebugMelt && GEngine)
+	if (bDebugMelt)
 	{
 		DebugAcc += DeltaTime;
 		if (DebugAcc >= 0.25f)
 		{
 			DebugAcc = 0.0f;
 			const FVector S = MeshComp->GetComponentScale();
-			const FString Msg = FString::Printf(
-				TEXT("ICE MELT | d=%.0fcm | W=%.1f | J=%.0f | A=%.3f | S=(%.2f,%.2f,%.2f)"),
-				DistCm, ReceivedPowerW, EnergyAccumJ, MeltAlpha, S.X, S.Y, S.Z
-			);
-			GEngine->AddOnScreenDebugMessage((uint64)GetUniqueID(), 0.3f, FColor::Cyan, Msg);
+			FHeatTelemetry::Get().Record({ 0.0, GetUniqueID(), DistCm, ReceivedPowerW, EnergyAccumJ, MeltAlpha, static_cast<float>(S.X) });
+
+#if !UE_BUILD_SHIPPING
+			if (FHeatTelemetry::ShowBlockText())
+			{
+				const FString Msg = FString::Printf(
+					TEXT("ICE MELT | d=%.0fcm | W=%.1f | J=%.0f | A=%.3f | S=(%.2f,%.2f,%.2f)"),
+					DistCm, ReceivedPowerW, EnergyAccumJ, MeltAlpha, S.X, S.Y, S.Z
+				);
+				GEngine->AddOnScreenDebugMessage((uint64)GetUniqueID(), 0.3f, FColor::Cyan, Msg);
+			}
+#endif
 		}
 	}
 
+	DepositMeltWater();
+
 	if (MeltAlpha >= 1.0f && bDestroyWhenMelted)
 	{
-		Destroy();
+		UActorPoolSubsystem::ReleaseOrDestroy(this);
 	}
 }
 
 void ATransformation_actor::SetForm(EBlockForm NewForm)
 {
+	MATERIALSIM_SCOPE(Form_SetForm);
+
 	if (CurrentForm == NewForm)
 	{
 		if (const FBlockFormSpec* Spec = FindSpec(CurrentForm))
 		{
 			ApplySpec(*Spec);
 		}
+		SyncHeatReceiver();
 		return;
 	}
 
+	INC_DWORD_STAT(STAT_MaterialSim_FormSwitches);
+
 	float SavedMeltAlpha = MeltAlpha;
 	float SavedEnergyAccumJ = EnergyAccumJ;
-	ATemperature* SavedFire = CurrentFire;
-	bool bWasHeating = bHeating;
-	FVector SavedCurrentScale = MeshComp ? MeshComp->GetComponentScale() : FVector(1, 1, 1);  
 
 	if (CurrentForm == EBlockForm::Ice)
 	{
 		ExitIceMode();
 	}
 
+	// read after ExitIceMode, which replaces the coarse melt scale with the exact one
+	FVector SavedCurrentScale = MeshComp ? MeshComp->GetComponentScale() : FVector(1, 1, 1);
+
 	CurrentForm = NewForm;
 
 	if (const FBlockFormSpec* Spec = FindSpec(CurrentForm))
@@ -145,11 +151,11 @@ void ATransformation_actor::SetForm(EBlockForm NewForm)
 		
 		MeltAlpha = SavedMeltAlpha;
 		EnergyAccumJ = SavedEnergyAccumJ;
-		CurrentFire = SavedFire;
-		bHeating = bWasHeating && (CurrentFire != nullptr);
 		
 		ApplyIceMeltVisual(MeltAlpha);
 	}
+
+	SyncHeatReceiver();
 }
 
 void ATransformation_actor::NextForm()
@@ -167,17 +173,177 @@ void ATransformation_actor::NextForm()
 	SetForm(CycleOrder[Idx]);
 }
 
-void ATransformation_actor::StartHeating(ATemperature* FireRef)
+void ATransformation_actor::ResetToForm(EBlockForm NewForm)
+{
+	// back to the unmelted size before the melt starts over from it
+	if (MeshComp && MeltAlpha > 0.0f)
+	{
+		MeshComp->SetWorldScale3D(BaseScaleBeforeMelt);
+	}
+
+	MeltAlpha = 0.0f;
+	EnergyAccumJ = 0.0f;
+	DepositedMeltAlpha = 0.0f;
+	AppliedScaleFactor = -1.0f;
+	DebugAcc = 0.0f;
+
+	CurrentForm = NewForm;
+	if (const FBlockFormSpec* Spec = FindSpec(CurrentForm))
+	{
+		ApplySpec(*Spec);
+	}
+
+	if (CurrentForm == EBlockForm::Ice)
+	{
+		InvalidateMeltParams();
+		EnterIceMode();
+		ApplyIceMeltVisual(0.0f);
+	}
+
+	SyncHeatReceiver(true);
+}
+
+void ATransformation_actor::RestoreThermalState(EBlockForm NewForm, float NewEnergyJ, float NewMeltAlpha, const FVector& UnmeltedScale)
+{
+	// from the unmelted size, so EnterIceMode picks it up as the base scale
+	if (MeshComp)
+	{
+		MeshComp->SetWorldScale3D(UnmeltedScale);
+	}
+	MeltAlpha = 0.0f;
+
+	ResetToForm(NewForm);
+
+	if (NewMeltAlpha <= 0.0f && NewEnergyJ <= 0.0f) return;
+
+	BaseScaleBeforeMelt = UnmeltedScale;
+	EnergyAccumJ = NewEnergyJ;
+	MeltAlpha = NewMeltAlpha;
+	DepositedMeltAlpha = NewMeltAlpha;
+
+	// other forms keep the melted size in the transform
+	ApplyIceMeltVisual(MeltAlpha);
+	SyncHeatReceiver(true);
+}
+
+void ATransformation_actor::ApplyReplicatedState(EBlockForm NewForm, float NewMeltAlpha)
+{
+	if (!MeshComp) return;
+
+	if (CurrentForm != NewForm)
+	{
+		SetForm(NewForm);
+	}
+
+	// the sim slot is corrected before the state is applied, which may release the block. The server's
+	// state replaces a local analytic prediction. A block about to be released is not registered again
+	EnergyAccumJ = NewMeltAlpha * TotalMeltEnergyJ;
+	MeltAlpha = NewMeltAlpha;
+	if (MeltAlpha < 1.0f || CurrentForm != EBlockForm::Ice || !bDestroyWhenMelted)
+	{
+		SyncHeatReceiver(true);
+	}
+
+	if (CurrentForm == EBlockForm::Ice)
+	{
+		ApplyHeatSimState(EnergyAccumJ, MeltAlpha, 0.0f, 0.0f, 0.0f);
+	}
+	else
+	{
+		ApplyIceMeltVisual(MeltAlpha);
+	}
+}
+
+void ATransformation_actor::OnAcquiredFromPool()
+{
+	ResetToForm(SpawnForm);
+}
+
+void ATransformation_actor::OnReturnedToPool()
+{
+	UnregisterHeatReceiver();
+	HeatingFires.Reset();
+
+	// the acquire transform sets the next size, not the melted one
+	MeltAlpha = 0.0f;
+
+	// a parked body without collision would keep falling
+	if (MeshComp)
+	{
+		MeshComp->SetSimulatePhysics(false);
+	}
+}
+
+void ATransformation_actor::BeginMeltTimeline(float StartAlpha, float StartTime, float EndTime)
 {
 	if (CurrentForm != EBlockForm::Ice) return;
-	CurrentFire = FireRef;
-	bHeating = (CurrentFire != nullptr);
+
+	MeltStartAlphaParam.Set(MeshComp, IceMID, bUseCPD, MeltStartAlphaParamName, CPDIndex_MeltTimeline, StartAlpha);
+	MeltStartTimeParam.Set(MeshComp, IceMID, bUseCPD, MeltStartTimeParamName, CPDIndex_MeltTimeline + 1, StartTime);
+	MeltEndTimeParam.Set(MeshComp, IceMID, bUseCPD, MeltEndTimeParamName, CPDIndex_MeltTimeline + 2, EndTime);
+}
+
+void ATransformation_actor::EndMeltTimeline()
+{
+	if (CurrentForm != EBlockForm::Ice) return;
+
+	MeltStartTimeParam.Set(MeshComp, IceMID, bUseCPD, MeltStartTimeParamName, CPDIndex_MeltTimeline + 1, 0.0f);
+	MeltEndTimeParam.Set(MeshComp, IceMID, bUseCPD, MeltEndTimeParamName, CPDIndex_MeltTimeline + 2, 0.0f);
+}
+
+void ATransformation_actor::StartHeating_Implementation(ATemperature* FireRef)
+{
+	if (!FireRef) return;
+
+	HeatingFires.AddUnique(FireRef);
+
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->AddReceiverSource(this, FireRef);
+	}
+}
+
+void ATransformation_actor::StopHeating_Implementation(ATemperature* FireRef)
+{
+	HeatingFires.RemoveSingleSwap(FireRef);
+
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->RemoveReceiverSource(this, FireRef);
+	}
+}
+
+bool ATransformation_actor::IsHeating_Implementation() const
+{
+	return CurrentForm == EBlockForm::Ice && HeatingFires.Num() > 0;
+}
+
+bool ATransformation_actor::GetHeatReceiverBody(FHeatReceiverBody& OutBody, float& OutEnergyAccumJ) const
+{
+	OutBody.VolumeM3 = VolumeM3;
+	OutBody.EffectiveAreaM2 = EffectiveAreaM2;
+	OutBody.TotalMeltEnergyJ = TotalMeltEnergyJ;
+	OutBody.SimTimeScale = SimTimeScale;
+	OutBody.bCanMelt = (CurrentForm == EBlockForm::Ice) && MeshComp != nullptr;
+	OutEnergyAccumJ = EnergyAccumJ;
+	return true;
+}
+
+void ATransformation_actor::SyncHeatReceiver(bool bAuthoritativeEnergy)
+{
+	UWorld* World = GetWorld();
+	UHeatSimSubsystem* HeatSim = World ? World->GetSubsystem<UHeatSimSubsystem>() : nullptr;
+	if (!HeatSim) return;
+
+	HeatSim->RegisterReceiver(this, bAuthoritativeEnergy);
 }
 
-void ATransformation_actor::StopHeating()
+void ATransformation_actor::UnregisterHeatReceiver()
 {
-	bHeating = false;
-	CurrentFire = nullptr;
+	if (UHeatSimSubsystem* HeatSim = GetWorld()->GetSubsystem<UHeatSimSubsystem>())
+	{
+		HeatSim->UnregisterReceiver(this);
+	}
 }
 
 const FBlockFormSpec* ATransformation_actor::FindSpec(EBlockForm Form) const
@@ -232,61 +398,56 @@ void ATransformation_actor::EnterIceMode()
 	{
 		BaseScaleBeforeMelt = MeshComp->GetComponentScale();
 		EnergyAccumJ = 0.0f;
+		DepositedMeltAlpha = 0.0f;
 	}
 	
 	DebugAcc = 0.0f;
 
 	RecalcIceMassAndEnergy();
 
-	IceMID = nullptr;
+	UMaterialInterface* BaseMaterial = IceMeltMaterial ? IceMeltMaterial : MeshComp->GetMaterial(0);
+	if (!BaseMaterial) return;
 
-	if (IceMeltMaterial)
+	// shared material, the melt goes through custom primitive data
+	if (bUseCPD)
 	{
-		IceMID = UMaterialInstanceDynamic::Create(IceMeltMaterial, this);
-		if (IceMID)
+		if (MeshComp->GetMaterial(0) != BaseMaterial)
 		{
-			MeshComp->SetMaterial(0, IceMID);
+			MeshComp->SetMaterial(0, BaseMaterial);
 		}
+		return;
 	}
-	else
+
+	// the MID survives other forms, so switching back to ice does not create a new one every time
+	const bool bReuse = IceMID && (BaseMaterial == IceMID || IceMID->Parent == BaseMaterial);
+	if (!bReuse)
 	{
-		UMaterialInterface* M0 = MeshComp->GetMaterial(0);
-		if (M0)
-		{
-			IceMID = UMaterialInstanceDynamic::Create(M0, this);
-			if (IceMID)
-			{
-				MeshComp->SetMaterial(0, IceMID);
-			}
-		}
+		IceMID = UMaterialInstanceDynamic::Create(BaseMaterial, this);
+		InvalidateMeltParams();
+	}
+
+	if (IceMID && MeshComp->GetMaterial(0) != IceMID)
+	{
+		MeshComp->SetMaterial(0, IceMID);
 	}
 }
 
 void ATransformation_actor::ExitIceMode()
 {
-	IceMID = nullptr;
+	// other forms have no material shrink, so bake the exact melted size into the transform
+	if (MeshComp)
+	{
+		const float Ratio = FMath::Clamp(MinScaleRatio, 0.0f, 1.0f);
+		AppliedScaleFactor = FMath::Lerp(1.0f, Ratio, FMath::Clamp(MeltAlpha, 0.0f, 1.0f));
+		MeshComp->SetWorldScale3D(BaseScaleBeforeMelt * AppliedScaleFactor);
+	}
 }
 
 void ATransformation_actor::RecalcIceMassAndEnergy()
 {
-	if (!MeshComp)
-	{
-		VolumeM3 = 1.0f;
-		EffectiveAreaM2 = 1.0f;
-		TotalMeltEnergyJ = IceDensityKgM3 * VolumeM3 * LatentHeatJPerKg;
-		return;
-	}
-
-	const FBoxSphereBounds B = MeshComp->Bounds;
-	const FVector SizeCm = B.BoxExtent * 2.0f;
-	const FVector SizeM = SizeCm / 100.0f;
-
-	VolumeM3 = FMath::Max(SizeM.X * SizeM.Y * SizeM.Z, 1e-6f);
-
-	const float Axy = SizeM.X * SizeM.Y;
-	const float Axz = SizeM.X * SizeM.Z;
-	const float Ayz = SizeM.Y * SizeM.Z;
-	EffectiveAreaM2 = FMath::Max3(Axy, Axz, Ayz);
+	const UStaticMesh* Mesh = MeshComp ? MeshComp->GetStaticMesh() : nullptr;
+	const FVector Scale = MeshComp ? MeshComp->GetComponentScale() : FVector::OneVector;
+	UThermalMeshData::GetScaledBody(Mesh, Scale, VolumeM3, EffectiveAreaM2);
 
 	const float MassKg = IceDensityKgM3 * VolumeM3;
 	TotalMeltEnergyJ = FMath::Max(MassKg * LatentHeatJPerKg, 1.0f);
@@ -298,15 +459,48 @@ void ATransformation_actor::ApplyIceMeltVisual(float Alpha01)
 
 	const float A = FMath::Clamp(Alpha01, 0.0f, 1.0f);
 	const float Ratio = FMath::Clamp(MinScaleRatio, 0.0f, 1.0f);
+	const float TargetFactor = FMath::Lerp(1.0f, Ratio, A);
 
-	const FVector From = BaseScaleBeforeMelt;
-	const FVector To = BaseScaleBeforeMelt * Ratio;
-	const FVector NewScale = FMath::Lerp(From, To, A);
+	// the transform only follows in coarse steps, the material shrinks the rest of the way
+	float ScaleFactor = TargetFactor;
+	if (bShrinkInMaterial && (IceMID || bUseCPD) && CurrentForm == EBlockForm::Ice)
+	{
+		const float Step = FMath::Clamp(ScaleSnapStep, 0.01f, 1.0f);
+		const float SnappedAlpha = A >= 1.0f ? 1.0f : FMath::FloorToFloat(A / Step) * Step;
+		ScaleFactor = FMath::Lerp(1.0f, Ratio, SnappedAlpha);
+	}
 
-	MeshComp->SetWorldScale3D(NewScale);
+	if (ScaleFactor != AppliedScaleFactor || !MeshComp->GetComponentScale().Equals(BaseScaleBeforeMelt * ScaleFactor))
+	{
+		MeshComp->SetWorldScale3D(BaseScaleBeforeMelt * ScaleFactor);
+		AppliedScaleFactor = ScaleFactor;
+	}
+
+	if (CurrentForm != EBlockForm::Ice) return;
 
-	if (IceMID)
+	MeltAlphaParam.Set(MeshComp, IceMID, bUseCPD, MeltParamName, CPDIndex_MeltAlpha, A);
+	MeltShrinkParam.Set(MeshComp, IceMID, bUseCPD, MeltShrinkParamName, CPDIndex_MeltShrink, ScaleFactor > 0.0f ? TargetFactor / ScaleFactor : 1.0f);
+}
+
+void ATransformation_actor::DepositMeltWater()
+{
+	// the water leaves in the same coarse steps as the transform, and the rest once fully melted
+	const float Melted = MeltAlpha - DepositedMeltAlpha;
+	if (Melted <= 0.0f || (MeltAlpha < 1.0f && Melted < FMath::Clamp(ScaleSnapStep, 0.01f, 1.0f))) return;
+
+	DepositedMeltAlpha = MeltAlpha;
+
+	if (UHeatPhaseSubsystem* Phase = GetWorld()->GetSubsystem<UHeatPhaseSubsystem>())
 	{
-		IceMID->SetScalarParameterValue(MeltParamName, A);
+		Phase->DepositMeltWater(this, GetActorLocation(), UHeatPhaseSubsystem::IceToWaterVolumeM3(VolumeM3 * Melted, IceDensityKgM3));
 	}
+}
+
+void ATransformation_actor::InvalidateMeltParams()
+{
+	MeltAlphaParam.Invalidate();
+	MeltShrinkParam.Invalidate();
+	MeltStartAlphaParam.Invalidate();
+	MeltStartTimeParam.Invalidate();
+	MeltEndTimeParam.Invalidate();
 }
\ No newline at end of file
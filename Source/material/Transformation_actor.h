@@ -2,6 +2,9 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "HeatReceiver.h"
+#include "HeatVisualParam.h"
+#include "ActorPoolSubsystem.h"
 #include "Transformation_actor.generated.h"
 
 class UStaticMeshComponent;
@@ -54,7 +57,7 @@ struct FBlockFormSpec
 };
 
 UCLASS()
-class MATERIAL_API ATransformation_actor : public AActor
+class MATERIAL_API ATransformation_actor : public AActor, public IHeatReceiver, public IPooledActor
 {
 	GENERATED_BODY()
 
@@ -63,7 +66,7 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void OnConstruction(const FTransform& Transform) override;
 
 public:
@@ -85,11 +88,36 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Form")
 	void NextForm();
 
-	UFUNCTION(BlueprintCallable, Category="Heat")
-	void StartHeating(ATemperature* FireRef);
+	/** Puts the block back to an unmelted NewForm, re-applying its spec. Used by puzzle resets and when reused from the pool */
+	UFUNCTION(BlueprintCallable, Category="Form")
+	void ResetToForm(EBlockForm NewForm);
+
+	/** Puts back a form and melt state saved by UHeatSnapshotSubsystem. Its melt water is treated as already deposited */
+	void RestoreThermalState(EBlockForm NewForm, float NewEnergyJ, float NewMeltAlpha, const FVector& UnmeltedScale);
+
+	/** Takes the server's form and melt alpha on a client. The local sim carries on predicting from it */
+	void ApplyReplicatedState(EBlockForm NewForm, float NewMeltAlpha);
+
+	float GetMeltAlpha() const { return MeltAlpha; }
+	float GetEnergyAccumJ() const { return EnergyAccumJ; }
 
-	UFUNCTION(BlueprintCallable, Category="Heat")
-	void StopHeating();
+	/** Size of the block before it started melting, in any form */
+	const FVector& GetBaseScaleBeforeMelt() const { return BaseScaleBeforeMelt; }
+
+	// ~begin IPooledActor interface
+	virtual void OnAcquiredFromPool() override;
+	virtual void OnReturnedToPool() override;
+	// ~end IPooledActor interface
+
+	// ~begin IHeatReceiver interface
+	virtual void StartHeating_Implementation(ATemperature* FireRef) override;
+	virtual void StopHeating_Implementation(ATemperature* FireRef) override;
+	virtual bool IsHeating_Implementation() const override;
+	virtual bool GetHeatReceiverBody(FHeatReceiverBody& OutBody, float& OutEnergyAccumJ) const override;
+	virtual void ApplyHeatSimState(float NewEnergyJ, float NewMeltAlpha, float ReceivedPowerW, float DistCm, float DeltaTime) override;
+	virtual void BeginMeltTimeline(float StartAlpha, float StartTime, float EndTime) override;
+	virtual void EndMeltTimeline() override;
+	// ~end IHeatReceiver interface
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
 	UMaterialInterface* IceMeltMaterial = nullptr;
@@ -97,9 +125,49 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
 	FName MeltParamName = TEXT("MeltAlpha");
 
+	/** Analytic melt timeline. While MeltEndTime > MeltStartTime the material lerps from MeltStartAlpha to 1 over that window of Time */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	FName MeltStartTimeParamName = TEXT("MeltStartTime");
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	FName MeltEndTimeParamName = TEXT("MeltEndTime");
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	FName MeltStartAlphaParamName = TEXT("MeltStartAlpha");
+
+	/** Pushes the melt parameters through custom primitive data on the shared IceMeltMaterial instead of a per-actor MID */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	bool bUseCPD = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual", meta=(EditCondition="bUseCPD"))
+	int32 CPDIndex_MeltAlpha = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual", meta=(EditCondition="bUseCPD"))
+	int32 CPDIndex_MeltShrink = 1;
+
+	/** First of three consecutive slots: timeline start alpha, start time, end time */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual", meta=(EditCondition="bUseCPD"))
+	int32 CPDIndex_MeltTimeline = 2;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Melt")
 	float MinScaleRatio = 0.15f;
 
+	/**
+	 *  Shrinks the mesh in the material (World Position Offset driven by MeltShrinkParamName) between coarse transform updates.
+	 *  Only for materials that read MeltShrink, otherwise the block visibly jumps from one ScaleSnapStep to the next
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Melt")
+	bool bShrinkInMaterial = false;
+
+	/** Melt alpha step at which the component scale, bounds and collision are updated when bShrinkInMaterial is set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Melt", meta=(ClampMin=0.01, ClampMax=1.0, EditCondition="bShrinkInMaterial"))
+	float ScaleSnapStep = 0.25f;
+
+	/** Scale factor relative to the current component scale, 1 = no extra shrink. The material scales around the object pivot */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Visual")
+	FName MeltShrinkParamName = TEXT("MeltShrink");
+
+	/** Returns the block to the actor pool once fully melted */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Ice|Melt")
 	bool bDestroyWhenMelted = false;
 
@@ -125,20 +193,42 @@ private:
 	void RecalcIceMassAndEnergy();
 	void ApplyIceMeltVisual(float Alpha01);
 
+	/** Pushes the body to the heat sim. bAuthoritativeEnergy makes EnergyAccumJ replace a running analytic prediction */
+	void SyncHeatReceiver(bool bAuthoritativeEnergy = false);
+	void UnregisterHeatReceiver();
+	void DepositMeltWater();
+
 	UPROPERTY(Transient)
 	UMaterialInstanceDynamic* IceMID = nullptr;
 
+	/** Every source currently in range. Kept while in another form so heating resumes when turning back to ice */
 	UPROPERTY(Transient)
-	ATemperature* CurrentFire = nullptr;
+	TArray<ATemperature*> HeatingFires;
+
+	/** Form at BeginPlay, restored when the block is reused from the pool */
+	EBlockForm SpawnForm = EBlockForm::Ice;
 
-	bool bHeating = false;
 	float MeltAlpha = 0.0f;
 	float EnergyAccumJ = 0.0f;
 
+	/** Melt alpha whose water has already been handed to UHeatPhaseSubsystem */
+	float DepositedMeltAlpha = 0.0f;
+
 	float VolumeM3 = 1.0f;
 	float EffectiveAreaM2 = 1.0f;
 	float TotalMeltEnergyJ = 1.0f;
 
 	FVector BaseScaleBeforeMelt = FVector(1.0f);
+
+	/** Scale factor last written to the component transform, negative until the first write */
+	float AppliedScaleFactor = -1.0f;
+
+	FHeatVisualParam MeltAlphaParam;
+	FHeatVisualParam MeltShrinkParam;
+	FHeatVisualParam MeltStartAlphaParam;
+	FHeatVisualParam MeltStartTimeParam;
+	FHeatVisualParam MeltEndTimeParam;
+
+	void InvalidateMeltParams();
 	float DebugAcc = 0.0f;
 };
@@ -0,0 +1,44 @@
+// VapourEffect.cpp
+
+#include "VapourEffect.h"
+
+#include "NiagaraComponent.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+AVapourEffect::AVapourEffect()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Effect = CreateDefaultSubobject<UNiagaraComponent>(TEXT("Effect"));
+	SetRootComponent(Effect);
+
+	Effect->SetAutoActivate(false);
+}
+
+void AVapourEffect::OnAcquiredFromPool()
+{
+	Effect->Activate(true);
+}
+
+void AVapourEffect::OnReturnedToPool()
+{
+	GetWorldTimerManager().ClearTimer(LingerTimer);
+	Effect->Deactivate();
+}
+
+void AVapourEffect::Refresh(float EvaporationPowerW, float Linger)
+{
+	if (!Effect->IsActive())
+	{
+		Effect->Activate(true);
+	}
+	Effect->SetVariableFloat(PowerParamName, EvaporationPowerW);
+
+	GetWorldTimerManager().SetTimer(LingerTimer, this, &AVapourEffect::OnLingerExpired, FMath::Max(Linger, 0.01f), false);
+}
+
+void AVapourEffect::OnLingerExpired()
+{
+	UActorPoolSubsystem::ReleaseOrDestroy(this);
+}
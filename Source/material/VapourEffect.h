@@ -0,0 +1,44 @@
+// VapourEffect.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ActorPoolSubsystem.h"
+#include "VapourEffect.generated.h"
+
+class UNiagaraComponent;
+
+/**
+ *  Steam rising off an evaporating puddle. Kept alive by Refresh while its puddle is heated,
+ *  and returned to the actor pool once nothing has refreshed it for the linger time.
+ */
+UCLASS()
+class MATERIAL_API AVapourEffect : public AActor, public IPooledActor
+{
+	GENERATED_BODY()
+
+public:
+	AVapourEffect();
+
+	// ~begin IPooledActor interface
+	virtual void OnAcquiredFromPool() override;
+	virtual void OnReturnedToPool() override;
+	// ~end IPooledActor interface
+
+	/** Keeps the effect running for another Linger seconds, at a rate following the evaporating power */
+	void Refresh(float EvaporationPowerW, float Linger);
+
+public:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Vapour|Components")
+	UNiagaraComponent* Effect;
+
+	/** Niagara user float set to the evaporating power in watts */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Vapour")
+	FName PowerParamName = TEXT("EvaporationPower");
+
+private:
+	FTimerHandle LingerTimer;
+
+	void OnLingerExpired();
+};
@@ -11,6 +11,7 @@
 #include "Engine/World.h"
 #include "Blueprint/UserWidget.h"
 #include "material.h"
+#include "HeatSnapshotSubsystem.h"
 #include "Widgets/Input/SVirtualJoystick.h"
 
 void ACombatPlayerController::BeginPlay()
@@ -78,6 +79,12 @@ void ACombatPlayerController::SetRespawnTransform(const FTransform& NewRespawn)
 
 void ACombatPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 {
+	// put the ice and heat sources back to how they were at the checkpoint
+	if (UHeatSnapshotSubsystem* Snapshot = GetWorld()->GetSubsystem<UHeatSnapshotSubsystem>())
+	{
+		Snapshot->RestoreCheckpoint();
+	}
+
 	// spawn a new character at the respawn transform
 	if (ACombatCharacter* RespawnedCharacter = GetWorld()->SpawnActor<ACombatCharacter>(CharacterClass, RespawnTransform))
 	{
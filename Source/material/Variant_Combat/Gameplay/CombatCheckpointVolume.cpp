@@ -4,6 +4,7 @@
 #include "CombatCheckpointVolume.h"
 #include "CombatCharacter.h"
 #include "CombatPlayerController.h"
+#include "HeatSnapshotSubsystem.h"
 
 ACombatCheckpointVolume::ACombatCheckpointVolume()
 {
@@ -41,6 +42,15 @@ void ACombatCheckpointVolume::OnOverlap(UPrimitiveComponent* OverlappedComponent
 
 			// update the player's respawn checkpoint
 			PC->SetRespawnTransform(PlayerCharacter->GetActorTransform());
+
+			// save the ice and heat sources so the room can be put back on respawn
+			if (bSaveThermalState)
+			{
+				if (UHeatSnapshotSubsystem* Snapshot = GetWorld()->GetSubsystem<UHeatSnapshotSubsystem>())
+				{
+					Snapshot->SaveCheckpoint();
+				}
+			}
 		}
 
 	}
@@ -23,6 +23,10 @@ public:
 
 protected:
 
+	/** If true, the thermal and form state of the level is saved with the checkpoint and restored on respawn */
+	UPROPERTY(EditAnywhere, Category="Checkpoint")
+	bool bSaveThermalState = true;
+
 	/** Set to true after use to avoid accidentally resetting the checkpoint */
 	bool bCheckpointUsed = false;
 
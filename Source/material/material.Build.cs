@@ -19,10 +19,13 @@ public class material : ModuleRules
 			"GameplayStateTreeModule",
 			"UMG",
 			"Slate",
-			"PhysicsCore"
+			"PhysicsCore",
+			"DeveloperSettings",
+			"MassEntity",
+			"NetCore"
 		});
 
-		PrivateDependencyModuleNames.AddRange(new string[] { });
+		PrivateDependencyModuleNames.AddRange(new string[] { "RenderCore", "RHI", "Niagara" });
 
 		PublicIncludePaths.AddRange(new string[] {
 			"material",
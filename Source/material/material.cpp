@@ -2,7 +2,17 @@
 
 #include "material.h"
 #include "Modules/ModuleManager.h"
+#include "MaterialSimStats.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, material, "material" );
 
-DEFINE_LOG_CATEGORY(Logmaterial)
\ No newline at end of file
+DEFINE_LOG_CATEGORY(Logmaterial)
+
+DEFINE_STAT(STAT_MaterialSim_Sources);
+DEFINE_STAT(STAT_MaterialSim_Receivers);
+DEFINE_STAT(STAT_MaterialSim_MassReceivers);
+DEFINE_STAT(STAT_MaterialSim_Pairs);
+DEFINE_STAT(STAT_MaterialSim_Applies);
+DEFINE_STAT(STAT_MaterialSim_NetworkEdges);
+DEFINE_STAT(STAT_MaterialSim_NetworkIterations);
+DEFINE_STAT(STAT_MaterialSim_FormSwitches);